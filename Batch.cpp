@@ -0,0 +1,231 @@
+#include "Batch.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+//========================== 0) One position ==========================//
+
+PositionOutput expandPosition(Board& board) {
+    PositionOutput out;
+    const Occupant side = board.nextToMove;
+    MoveList moves;
+    board.generateMoves(side, moves);
+    for (const CompactMove& m : moves) {
+        Board::appendMoveNotation(out.moves, m, side);
+        out.moves += '\n';
+        MoveUndo undo = board.applyMove(m);
+        board.appendBoardString(out.boards);
+        out.boards += '\n';
+        board.undoMove(undo);
+    }
+    out.moveCount = moves.size();
+    return out;
+}
+
+//========================== 1) Collecting inputs ==========================//
+
+// A position to process: either a file to load or the text of a stdin record
+struct BatchJob
+{
+    std::string name;
+    std::string path;
+    std::string text;
+};
+
+static std::string trimLine(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos)
+        return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+// "dir/Test7.input" -> "dir/7"; any other "dir/name.input" -> "dir/name"
+static std::string outputStem(const std::string& path) {
+    fs::path p(path);
+    std::string stem = p.stem().string();
+    if (stem.size() > 4 && stem.compare(0, 4, "Test") == 0
+        && std::all_of(stem.begin() + 4, stem.end(), [](unsigned char c) { return std::isdigit(c); }))
+        stem = stem.substr(4);
+    return (p.parent_path() / stem).string();
+}
+
+static bool collectJobs(const std::string& source, std::vector<BatchJob>& jobs) {
+    if (source == "-") {
+        // Stream of two-line records; blank lines between records are ignored.
+        std::string line, first;
+        int index = 0;
+        while (std::getline(std::cin, line)) {
+            line = trimLine(line);
+            if (line.empty())
+                continue;
+            if (first.empty()) {
+                first = line;
+                continue;
+            }
+            jobs.push_back({ "stdin#" + std::to_string(++index), "", first + "\n" + line + "\n" });
+            first.clear();
+        }
+        return true;
+    }
+
+    std::error_code ec;
+    if (fs::is_directory(source, ec)) {
+        for (const auto& entry : fs::directory_iterator(source, ec))
+            if (entry.is_regular_file() && entry.path().extension() == ".input")
+                jobs.push_back({ entry.path().string(), entry.path().string(), "" });
+        std::sort(jobs.begin(), jobs.end(), [](const BatchJob& a, const BatchJob& b) { return a.path < b.path; });
+        return true;
+    }
+
+    // A single position file, not a list of them
+    if (fs::is_regular_file(source, ec) && fs::path(source).extension() == ".input") {
+        jobs.push_back({ source, source, "" });
+        return true;
+    }
+
+    std::ifstream manifest(source);
+    if (!manifest.is_open()) {
+        std::cerr << "Error: could not open " << source << "\n";
+        return false;
+    }
+    const fs::path base = fs::path(source).parent_path();
+    std::string line;
+    while (std::getline(manifest, line)) {
+        line = trimLine(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+        fs::path p(line);
+        if (p.is_relative())
+            p = base / p;
+        jobs.push_back({ p.string(), p.string(), "" });
+    }
+    return true;
+}
+
+//========================== 2) Worker pool ==========================//
+
+int runBatch(int argc, char* argv[]) {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string combinedPrefix;
+    std::string source;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--combined" && i + 1 < argc)
+            combinedPrefix = argv[++i];
+        else
+            source = arg;
+    }
+    if (source.empty()) {
+        std::cerr << "usage: " << argv[0]
+            << " batch [--threads N] [--combined PREFIX] <directory | file.input | manifest | ->\n";
+        return 1;
+    }
+    if (source == "-" && combinedPrefix.empty())
+        combinedPrefix = "batch";
+    const bool combined = !combinedPrefix.empty();
+
+    std::vector<BatchJob> jobs;
+    if (!collectJobs(source, jobs))
+        return 1;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<PositionOutput> results(jobs.size());
+    std::vector<char> loaded(jobs.size(), 0);
+    std::vector<int> moveCounts(jobs.size(), 0);
+    std::vector<char> done(jobs.size(), 0);
+    std::mutex doneMutex;
+    std::condition_variable doneSignal;
+    std::atomic<size_t> nextJob{ 0 };
+
+    auto worker = [&]() {
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+            const BatchJob& job = jobs[i];
+            Board board;
+            bool ok;
+            if (job.path.empty()) {
+                std::istringstream in(job.text);
+                ok = board.loadFromStream(in);
+            } else {
+                ok = board.loadFromInputFile(job.path);
+            }
+
+            PositionOutput out;
+            if (!ok)
+                std::cerr << "Error: skipping " << job.name << "\n";
+            if (ok) {
+                out = expandPosition(board);
+                if (!combined) {
+                    const std::string stem = outputStem(job.path);
+                    std::ofstream(stem + "-moves.txt") << out.moves;
+                    std::ofstream(stem + "-boards.txt") << out.boards;
+                    out.moves.clear();
+                    out.boards.clear();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(doneMutex);
+            loaded[i] = ok;
+            moveCounts[i] = out.moveCount;
+            results[i] = std::move(out);
+            done[i] = 1;
+            doneSignal.notify_one();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < std::min<size_t>(threads, std::max<size_t>(jobs.size(), 1)); t++)
+        pool.emplace_back(worker);
+
+    // Combined output: write each position as soon as it and all before it are done,
+    // so memory holds only the positions that finished out of order.
+    if (combined) {
+        std::ofstream movesFile(combinedPrefix + "-moves.txt");
+        std::ofstream boardsFile(combinedPrefix + "-boards.txt");
+        for (size_t i = 0; i < jobs.size(); i++) {
+            PositionOutput out;
+            {
+                std::unique_lock<std::mutex> lock(doneMutex);
+                doneSignal.wait(lock, [&] { return done[i] != 0; });
+                out = std::move(results[i]);
+            }
+            if (i > 0) {
+                movesFile << "\n";
+                boardsFile << "\n";
+            }
+            movesFile << out.moves;
+            boardsFile << out.boards;
+        }
+    }
+
+    for (std::thread& t : pool)
+        t.join();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t succeeded = 0;
+    long long totalMoves = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        succeeded += loaded[i] ? 1 : 0;
+        totalMoves += moveCounts[i];
+    }
+    std::cout << "positions " << succeeded << " (" << (jobs.size() - succeeded) << " failed)"
+        << ", moves " << totalMoves << ", threads " << pool.size()
+        << ", time " << seconds << "s"
+        << ", " << (seconds > 0 ? succeeded / seconds : 0.0) << " positions/s\n";
+    return succeeded == jobs.size() ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+#ifndef ABALONE_BATCH_H
+#define ABALONE_BATCH_H
+
+#include "Board.h"
+#include <string>
+
+// Batch mode: the one-ply moves/boards dump of main.cpp over many positions.
+//
+//   abalone batch [--threads N] [--combined PREFIX] <directory | file.input | manifest | ->
+//
+// Inputs are every *.input file in a directory (sorted by name), one .input
+// file, the paths listed one per line in a manifest file (relative to the
+// manifest), or positions streamed on stdin ("-") as consecutive two-line records.
+// File inputs get their own <name>-moves.txt / <name>-boards.txt beside them
+// (TestN.input -> N-moves.txt, as main.cpp does for Test1). With --combined,
+// or for stdin, all positions go to PREFIX-moves.txt / PREFIX-boards.txt in
+// input order, one blank line between positions.
+
+// Moves and resulting boards for the side to move, one per line, in generator order
+struct PositionOutput
+{
+    std::string moves;
+    std::string boards;
+    int moveCount = 0;
+};
+
+PositionOutput expandPosition(Board& board);
+
+int runBatch(int argc, char* argv[]);
+
+#endif // ABALONE_BATCH_H
@@ -0,0 +1,152 @@
+#include "BitBoard.h"
+
+//========================== 0) Layout tables ==========================//
+
+// The tables are constexpr members built by BitLayout; check the shifts match the
+// padded-grid comment in BitBoard.h (W, E, NW, NE, SW, SE).
+static_assert(BitBoard::DIRECTION_SHIFTS[0] == -1 && BitBoard::DIRECTION_SHIFTS[1] == +1
+    && BitBoard::DIRECTION_SHIFTS[2] == +10 && BitBoard::DIRECTION_SHIFTS[3] == +11
+    && BitBoard::DIRECTION_SHIFTS[4] == -11 && BitBoard::DIRECTION_SHIFTS[5] == -10,
+    "direction shifts disagree with the padded layout");
+
+//========================== 1) Conversion ==========================//
+
+BitBoard BitBoard::fromBoard(const Board& board) {
+    BitBoard bb;
+    for (int i = 0; i < Board::NUM_CELLS; i++) {
+        if (board.occupant[i] == Occupant::BLACK)
+            bb.black.set(CELL_TO_BIT[i]);
+        else if (board.occupant[i] == Occupant::WHITE)
+            bb.white.set(CELL_TO_BIT[i]);
+    }
+    bb.nextToMove = board.nextToMove;
+    return bb;
+}
+
+Board BitBoard::toBoard() const {
+    Board board;
+    forEachBit(black, [&](int bit) { board.occupant[BIT_TO_CELL[bit]] = Occupant::BLACK; });
+    forEachBit(white, [&](int bit) { board.occupant[BIT_TO_CELL[bit]] = Occupant::WHITE; });
+    board.nextToMove = nextToMove;
+    board.refreshIncremental();
+    return board;
+}
+
+//========================== 2) Move generation ==========================//
+
+void BitBoard::emitGroupMoves(const BitMask& tails, int size, int axisShift, int direction,
+    bool isInline, int pushCount, MoveList& moves) {
+    forEachBit(tails, [&](int bit) {
+        int cells[3] = { CompactMove::NO_CELL, CompactMove::NO_CELL, CompactMove::NO_CELL };
+        for (int k = 0; k < size; k++)
+            cells[k] = BIT_TO_CELL[bit + k * axisShift];
+        moves.push_back(CompactMove(cells[0], cells[1], cells[2], size, direction, isInline, pushCount));
+    });
+}
+
+void BitBoard::generateMoves(Occupant side, MoveList& moves) const {
+    const BitMask own = pieces(side);
+    const BitMask opp = pieces(side == Occupant::BLACK ? Occupant::WHITE : Occupant::BLACK);
+    const BitMask occ = own | opp;
+    const BitMask empty = VALID & ~occ;
+
+    // "Cell at offset s from this bit is empty" for each direction, reused by side-steps.
+    std::array<BitMask, Board::NUM_DIRECTIONS> emptyAhead;
+    for (int d = 0; d < Board::NUM_DIRECTIONS; d++)
+        emptyAhead[d] = shiftBy(empty, -DIRECTION_SHIFTS[d]);
+
+    // -------- 1. Single marbles: step into an empty neighbour --------
+    for (int d = 0; d < Board::NUM_DIRECTIONS; d++)
+        emitGroupMoves(own & emptyAhead[d], 1, 0, d, true, 0, moves);
+
+    // -------- 2. Lines of 2 and 3 along the three positive axes (E, NW, NE) --------
+    // Each group is identified by its tail, the lowest cell; the rest follow at +s, +2s.
+    // Shifting in zeros at either end of the mask reads as "empty or off-board",
+    // which is exactly the condition for the last pushed marble's destination.
+    for (int axis : { 1, 2, 3 }) {
+        const int s = DIRECTION_SHIFTS[axis];
+        const int back = Board::OPPOSITE_DIRECTION[axis];
+
+        const BitMask pairs = own & (own >> s);
+        const BitMask triples = pairs & (own >> (2 * s));
+
+        // Two marbles forward: destination t+2s, pushed marble lands on t+3s.
+        emitGroupMoves(pairs & (empty >> (2 * s)), 2, s, axis, true, 0, moves);
+        emitGroupMoves(pairs & (opp >> (2 * s)) & ~(occ >> (3 * s)), 2, s, axis, true, 1, moves);
+
+        // Two marbles backward: destination t-s, pushed marble lands on t-2s.
+        emitGroupMoves(pairs & (empty << s), 2, s, back, true, 0, moves);
+        emitGroupMoves(pairs & (opp << s) & ~(occ << (2 * s)), 2, s, back, true, 1, moves);
+
+        // Three marbles forward: destination t+3s.
+        const BitMask oppFront = triples & (opp >> (3 * s));
+        emitGroupMoves(triples & (empty >> (3 * s)), 3, s, axis, true, 0, moves);
+        emitGroupMoves(oppFront & ~(occ >> (4 * s)), 3, s, axis, true, 1, moves);
+        emitGroupMoves(oppFront & (opp >> (4 * s)) & ~(occ >> (5 * s)), 3, s, axis, true, 2, moves);
+
+        // Three marbles backward: destination t-s.
+        const BitMask oppBack = triples & (opp << s);
+        emitGroupMoves(triples & (empty << s), 3, s, back, true, 0, moves);
+        emitGroupMoves(oppBack & ~(occ << (2 * s)), 3, s, back, true, 1, moves);
+        emitGroupMoves(oppBack & (opp << (2 * s)) & ~(occ << (3 * s)), 3, s, back, true, 2, moves);
+
+        // Side-steps: every marble of the group needs an empty cell in direction sd.
+        for (int sd = 0; sd < Board::NUM_DIRECTIONS; sd++) {
+            if (sd == axis || sd == back)
+                continue;
+            const BitMask pairFree = pairs & emptyAhead[sd] & (emptyAhead[sd] >> s);
+            emitGroupMoves(pairFree, 2, s, sd, false, 0, moves);
+            emitGroupMoves(pairFree & triples & (emptyAhead[sd] >> (2 * s)), 3, s, sd, false, 0, moves);
+        }
+    }
+}
+
+void BitBoard::generateMoves(Occupant side, std::vector<Move>& moves) const {
+    MoveList list;
+    generateMoves(side, list);
+    for (const CompactMove& m : list)
+        moves.push_back(m.toMove());
+}
+
+std::vector<Move> BitBoard::generateMoves(Occupant side) const {
+    std::vector<Move> moves;
+    moves.reserve(128);
+    generateMoves(side, moves);
+    return moves;
+}
+
+//========================== 3) Applying moves ==========================//
+
+void BitBoard::applyMove(const CompactMove& m) {
+    const int n = m.size();
+    if (n == 0) return;
+
+    const int s = DIRECTION_SHIFTS[m.direction()];
+    Occupant side = black.test(CELL_TO_BIT[m.cells[0]]) ? Occupant::BLACK : Occupant::WHITE;
+    BitMask& own = pieces(side);
+    BitMask& opp = pieces(side == Occupant::BLACK ? Occupant::WHITE : Occupant::BLACK);
+
+    BitMask group;
+    for (int k = 0; k < n; k++)
+        group.set(CELL_TO_BIT[m.cells[k]]);
+
+    if (m.isInline() && m.pushCount() > 0) {
+        // Cells are ascending, so the leading marble is the last one when moving up the mask.
+        int front = CELL_TO_BIT[s > 0 ? m.cells[n - 1] : m.cells[0]];
+        BitMask pushed;
+        for (int k = 1; k <= m.pushCount(); k++)
+            pushed.set(front + k * s);
+        opp ^= pushed;
+        // Anything shifted onto a padding bit has left the board.
+        opp |= shiftBy(pushed, s) & VALID;
+    }
+
+    own ^= group;
+    own |= shiftBy(group, s);
+
+    nextToMove = (side == Occupant::BLACK ? Occupant::WHITE : Occupant::BLACK);
+}
+
+void BitBoard::applyMove(const Move& m) {
+    applyMove(CompactMove::fromMove(m));
+}
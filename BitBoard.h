@@ -0,0 +1,167 @@
+#ifndef ABALONE_BITBOARD_H
+#define ABALONE_BITBOARD_H
+
+#include "Board.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+
+// 128-bit occupancy mask stored as two 64-bit words.
+//
+// Cells are laid out on a padded 9x10 grid: bit = (y - 1) * 10 + (m - 1).
+// Column 9 of every row is never a valid cell, so a one-step shift in any
+// direction either lands on the right neighbour or on a padding bit that
+// VALID masks away. Direction shifts (same order as Board::DIRECTION_OFFSETS):
+//  W = -1, E = +1, NW = +10, NE = +11, SW = -11, SE = -10
+struct BitMask
+{
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool any() const { return (lo | hi) != 0; }
+
+    BitMask operator&(const BitMask& o) const { return { lo & o.lo, hi & o.hi }; }
+    BitMask operator|(const BitMask& o) const { return { lo | o.lo, hi | o.hi }; }
+    BitMask operator^(const BitMask& o) const { return { lo ^ o.lo, hi ^ o.hi }; }
+    BitMask operator~() const { return { ~lo, ~hi }; }
+    BitMask& operator&=(const BitMask& o) { lo &= o.lo; hi &= o.hi; return *this; }
+    BitMask& operator|=(const BitMask& o) { lo |= o.lo; hi |= o.hi; return *this; }
+    BitMask& operator^=(const BitMask& o) { lo ^= o.lo; hi ^= o.hi; return *this; }
+    bool operator==(const BitMask& o) const { return lo == o.lo && hi == o.hi; }
+
+    // Move every bit towards higher positions by s (0 < s < 64).
+    BitMask operator<<(int s) const { return { lo << s, (hi << s) | (lo >> (64 - s)) }; }
+    // Move every bit towards lower positions by s (0 < s < 64).
+    BitMask operator>>(int s) const { return { (lo >> s) | (hi << (64 - s)), hi >> s }; }
+
+    constexpr void set(int bit)
+    {
+        if (bit < 64) lo |= uint64_t(1) << bit;
+        else hi |= uint64_t(1) << (bit - 64);
+    }
+
+    constexpr bool test(int bit) const
+    {
+        return bit < 64 ? (lo >> bit) & 1 : (hi >> (bit - 64)) & 1;
+    }
+};
+
+// Shift a mask by a signed amount: positive moves bits up, negative moves them down.
+inline BitMask shiftBy(const BitMask& x, int s)
+{
+    if (s > 0) return x << s;
+    if (s < 0) return x >> -s;
+    return x;
+}
+
+// Call fn(bit) for every set bit, lowest first.
+template <typename Fn>
+inline void forEachBit(const BitMask& x, Fn fn)
+{
+    for (uint64_t w = x.lo; w; w &= w - 1)
+        fn(__builtin_ctzll(w));
+    for (uint64_t w = x.hi; w; w &= w - 1)
+        fn(64 + __builtin_ctzll(w));
+}
+
+
+// The padded layout, built at compile time from HexTopology's cell coordinates
+struct BitLayout
+{
+    static constexpr int NUM_BITS = 90;      // 9 rows of 10, column 9 is padding
+    static constexpr int ROW_STRIDE = 10;
+
+    static constexpr int bitOf(const HexCoord& c) { return (c.y - 1) * ROW_STRIDE + (c.m - 1); }
+
+    static constexpr std::array<int, HexTopology::NUM_CELLS> buildCellToBit()
+    {
+        std::array<int, HexTopology::NUM_CELLS> table{};
+        const auto coords = HexTopology::buildIndexToCoord();
+        for (int i = 0; i < HexTopology::NUM_CELLS; i++)
+            table[i] = bitOf(coords[i]);
+        return table;
+    }
+
+    static constexpr std::array<int, NUM_BITS> buildBitToCell()
+    {
+        std::array<int, NUM_BITS> table{};
+        for (int b = 0; b < NUM_BITS; b++)
+            table[b] = -1;
+        const auto coords = HexTopology::buildIndexToCoord();
+        for (int i = 0; i < HexTopology::NUM_CELLS; i++)
+            table[bitOf(coords[i])] = i;
+        return table;
+    }
+
+    static constexpr BitMask buildValid()
+    {
+        BitMask valid;
+        const auto coords = HexTopology::buildIndexToCoord();
+        for (int i = 0; i < HexTopology::NUM_CELLS; i++)
+            valid.set(bitOf(coords[i]));
+        return valid;
+    }
+
+    // One step (dm, dy) moves a bit by dy rows and dm columns
+    static constexpr std::array<int, HexTopology::NUM_DIRECTIONS> buildDirectionShifts()
+    {
+        std::array<int, HexTopology::NUM_DIRECTIONS> shifts{};
+        for (int d = 0; d < HexTopology::NUM_DIRECTIONS; d++)
+            shifts[d] = HexTopology::DY[d] * ROW_STRIDE + HexTopology::DM[d];
+        return shifts;
+    }
+};
+
+// Bitboard view of a position: one 128-bit occupancy mask per colour.
+// Move generation works on whole masks at once using directional shifts,
+// and produces the same move set (same Move encoding) as Board::generateMoves.
+class BitBoard
+{
+public:
+    static constexpr int NUM_BITS = BitLayout::NUM_BITS;
+    static constexpr int ROW_STRIDE = BitLayout::ROW_STRIDE;
+
+    // Bit shift for each direction, indexed like Board::DIRECTION_OFFSETS
+    static constexpr std::array<int, Board::NUM_DIRECTIONS> DIRECTION_SHIFTS = BitLayout::buildDirectionShifts();
+
+    // Bits that correspond to one of the 61 real cells
+    static constexpr BitMask VALID = BitLayout::buildValid();
+
+    // Cell index <-> bit position
+    static constexpr std::array<int, Board::NUM_CELLS> CELL_TO_BIT = BitLayout::buildCellToBit();
+    static constexpr std::array<int, NUM_BITS> BIT_TO_CELL = BitLayout::buildBitToCell(); // -1 for padding / off-board bits
+
+    BitMask black;
+    BitMask white;
+    Occupant nextToMove = Occupant::BLACK;
+
+    BitBoard() = default;
+
+    // Convert from / to the array representation
+    static BitBoard fromBoard(const Board& board);
+    Board toBoard() const;
+
+    const BitMask& pieces(Occupant side) const { return side == Occupant::BLACK ? black : white; }
+    BitMask& pieces(Occupant side) { return side == Occupant::BLACK ? black : white; }
+
+    // Generate all legal moves for 'side', appending to 'moves'
+    void generateMoves(Occupant side, MoveList& moves) const;
+    void generateMoves(Occupant side, std::vector<Move>& moves) const;
+
+    // Convenience wrapper matching Board::generateMoves
+    std::vector<Move> generateMoves(Occupant side) const;
+
+    // Apply a move produced by generateMoves (no legality checks) and pass the turn,
+    // mirroring Board::applyMove
+    void applyMove(const CompactMove& m);
+    void applyMove(const Move& m);
+
+private:
+    // Emit one move per set bit of 'tails'; each tail is the lowest cell of a
+    // group of 'size' marbles aligned along 'axisShift'.
+    static void emitGroupMoves(const BitMask& tails, int size, int axisShift, int direction,
+        bool isInline, int pushCount, MoveList& moves);
+};
+
+#endif // ABALONE_BITBOARD_H
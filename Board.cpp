@@ -1,28 +1,17 @@
 #include "Board.h"
-#include <stdexcept>
+#include "PositionReader.h"
+#include "Trace.h"
 #include <cctype>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <algorithm>
 #include <iostream>
 
-// Directions in (dm, dy) form, matching your doc
-const std::array<std::pair<int, int>, Board::NUM_DIRECTIONS> Board::DIRECTION_OFFSETS = { {
-    {-1,  0}, // W
-    {+1,  0}, // E
-    { 0, +1}, // NW
-    {+1, +1}, // NE
-    {-1, -1}, // SW
-    { 0, -1}  // SE
-} };
-
 //========================== 0) Move Logic ==========================//
 
-
 std::vector<Move> Board::generateMoves(Occupant side) const {
     std::vector<Move> moves;
+    MoveKeySet seen;
     static const char* DIRS[] = { "W", "E", "NW", "NE", "SW", "SE" };
 
     // Loop through all board cells.
@@ -32,7 +21,7 @@ std::vector<Move> Board::generateMoves(Occupant side) const {
             continue;
 
         // -------- 1. Single Marble Moves --------
-        std::cout << "Checking single marble at " << indexToNotation(i) << "\n";
+        ABALONE_TRACE(Trace::CELL, "Checking single marble at " << indexToNotation(i));
         for (int d = 0; d < NUM_DIRECTIONS; d++) {
             int nIdx = neighbors[i][d];
             if (nIdx >= 0 && occupant[nIdx] == Occupant::EMPTY) {
@@ -40,15 +29,16 @@ std::vector<Move> Board::generateMoves(Occupant side) const {
                 mv.marbleIndices.push_back(i);
                 mv.direction = d;
                 mv.isInline = true; // single marble—no pushing.
-                std::cout << "  Single move: " << indexToNotation(i) << " -> "
-                    << indexToNotation(nIdx) << " (dir " << d << " [" << DIRS[d] << "])\n";
-                moves.push_back(mv);
+                ABALONE_TRACE(Trace::GROUP, "  Single move: " << indexToNotation(i) << " -> "
+                    << indexToNotation(nIdx) << " (dir " << d << " [" << DIRS[d] << "])");
+                pushUnique(moves, mv, seen);
             }
         }
 
         // -------- 2. Group Formation: Two- and Three-Marble Groups --------
-        // For each direction, see if a friendly marble is adjacent.
-        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+        // Only E, NW and NE lead to higher indices, so i is the lowest cell of every
+        // group formed here and each group is reached from exactly one anchor.
+        for (int d = 1; d <= 3; d++) {
             int j = neighbors[i][d];
             if (j < 0 || occupant[j] != side)
                 continue;
@@ -56,30 +46,21 @@ std::vector<Move> Board::generateMoves(Occupant side) const {
             std::vector<int> group = { i, j };
 
             // Debug: Print 2-marble group attempt.
-            std::cout << "Attempting 2-marble group from " << indexToNotation(i)
-                << " in direction " << d << " [" << DIRS[d] << "]\n";
-
-            // Check for duplicate group: only proceed if i is the minimum.
-            if (i != *std::min_element(group.begin(), group.end()))
-                continue;
+            ABALONE_TRACE(Trace::CELL, "Attempting 2-marble group from " << indexToNotation(i)
+                << " in direction " << d << " [" << DIRS[d] << "]");
 
             // Generate moves for the 2-marble group.
-            generateGroupMoves(group, d, moves);
+            generateGroupMoves(group, d, moves, seen);
 
             // Now try to extend the group to 3 marbles (in the same direction).
             int k = neighbors[j][d];
             if (k >= 0 && occupant[k] == side) {
                 group.push_back(k);
-                std::cout << "Extended group to 3 marbles: ";
-                for (int cell : group)
-                    std::cout << indexToNotation(cell) << " ";
-                std::cout << "(direction " << d << " [" << DIRS[d] << "])\n";
-
-                if (i != *std::min_element(group.begin(), group.end()))
-                    continue;
+                ABALONE_TRACE(Trace::CELL, "Extended group to 3 marbles: " << indexToNotation(i) << " "
+                    << indexToNotation(j) << " " << indexToNotation(k) << " (direction " << d << " [" << DIRS[d] << "])");
 
                 // Generate moves for the 3-marble group.
-                generateGroupMoves(group, d, moves);
+                generateGroupMoves(group, d, moves, seen);
             }
         }
     }
@@ -89,13 +70,20 @@ std::vector<Move> Board::generateMoves(Occupant side) const {
 // Helper function to generate moves (inline and side-step) for a given group.
 // The parameter 'd' is the direction in which the group is aligned.
 void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector<Move>& moves) const {
+    MoveKeySet seen;
+    generateGroupMoves(group, d, moves, seen);
+}
+
+void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector<Move>& moves, MoveKeySet& seen) const {
     static const char* DIRS[] = { "W", "E", "NW", "NE", "SW", "SE" };
-    // Build a string representation for debugging.
+    // Build a string representation for debugging (only when tracing groups).
     std::string groupStr;
-    for (int idx : group)
-        groupStr += indexToNotation(idx) + " ";
-    std::cout << "  Generating moves for group (" << groupStr << "), aligned in direction "
-        << d << " [" << DIRS[d] << "], group size: " << group.size() << "\n";
+    if constexpr (Trace::enabled(Trace::GROUP)) {
+        for (int idx : group)
+            groupStr += indexToNotation(idx) + " ";
+    }
+    ABALONE_TRACE(Trace::GROUP, "  Generating moves for group (" << groupStr << "), aligned in direction "
+        << d << " [" << DIRS[d] << "], group size: " << group.size());
 
     // ---- Inline Moves ----
     // Forward inline: destination for the front marble.
@@ -108,9 +96,9 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
             mv.direction = d;
             mv.isInline = true;
             // No push required.
-            std::cout << "    Inline forward move: group (" << groupStr << ") can move forward into "
-                << indexToNotation(frontDest) << " (dir " << d << " [" << DIRS[d] << "])\n";
-            moves.push_back(mv);
+            ABALONE_TRACE(Trace::GROUP, "    Inline forward move: group (" << groupStr << ") can move forward into "
+                << indexToNotation(frontDest) << " (dir " << d << " [" << DIRS[d] << "])");
+            pushUnique(moves, mv, seen);
         }
         // Check push possibility forward:
         else if (occupant[frontDest] != occupant[group[0]]) {  // opponent present
@@ -118,17 +106,17 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
             if (group.size() == 2) {
                 bool canPush = true;
                 int current = frontDest;
-                std::cout << "    Checking forward push for 2-marble group (" << groupStr
+                ABALONE_TRACE(Trace::CELL, "    Checking forward push for 2-marble group (" << groupStr
                     << ") in direction " << d << " [" << DIRS[d] << "], starting at "
-                    << indexToNotation(frontDest) << "\n";
+                    << indexToNotation(frontDest));
                 int nextChain = neighbors[current][d];
-                std::cout << "      Push chain: " << indexToNotation(current)
-                    << " -> " << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board") << "\n";
-                if (nextChain < 0 || (nextChain >= 0 && occupant[nextChain] != Occupant::EMPTY)) {
+                ABALONE_TRACE(Trace::CELL, "      Push chain: " << indexToNotation(current)
+                    << " -> " << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board"));
+                if (nextChain >= 0 && occupant[nextChain] != Occupant::EMPTY) {
                     canPush = false;
-                    std::cout << "      Cannot push: destination "
+                    ABALONE_TRACE(Trace::CELL, "      Cannot push: destination "
                         << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board")
-                        << " is not empty.\n";
+                        << " is not empty.");
                 }
                 if (canPush) {
                     Move mv;
@@ -136,8 +124,8 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
                     mv.direction = d;
                     mv.isInline = true;
                     mv.pushCount = 1; // record that we push one marble.
-                    std::cout << "    Forward push move generated for 2-marble group (" << groupStr << ")\n";
-                    moves.push_back(mv);
+                    ABALONE_TRACE(Trace::GROUP, "    Forward push move generated for 2-marble group (" << groupStr << ")");
+                    pushUnique(moves, mv, seen);
                 }
             }
             // For groups of 3, allow pushing either one or two opponent marbles.
@@ -151,9 +139,9 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
                     mv.direction = d;
                     mv.isInline = true;
                     mv.pushCount = 1;
-                    std::cout << "    Forward push move generated for 3-marble group (" << groupStr
-                        << ") pushing one marble\n";
-                    moves.push_back(mv);
+                    ABALONE_TRACE(Trace::GROUP, "    Forward push move generated for 3-marble group (" << groupStr
+                        << ") pushing one marble");
+                    pushUnique(moves, mv, seen);
                 }
                 // --- Case 2: Push two opponent marbles ---
                 // Ensure the first opponent cell is occupied.
@@ -168,9 +156,9 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
                             mv.direction = d;
                             mv.isInline = true;
                             mv.pushCount = 2;
-                            std::cout << "    Forward push move generated for 3-marble group (" << groupStr
-                                << ") pushing two marbles\n";
-                            moves.push_back(mv);
+                            ABALONE_TRACE(Trace::GROUP, "    Forward push move generated for 3-marble group (" << groupStr
+                                << ") pushing two marbles");
+                            pushUnique(moves, mv, seen);
                         }
                     }
                 }
@@ -179,7 +167,7 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
     }
 
     // ---- Backward inline moves (similar logic with opposite direction) ----
-    int opp = (d + 3) % 6;
+    int opp = OPPOSITE_DIRECTION[d];
     int back = group.front();
     int backDest = neighbors[back][opp];
     if (backDest >= 0) {
@@ -188,25 +176,25 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
             mv.marbleIndices = group;
             mv.direction = opp;
             mv.isInline = true;
-            std::cout << "    Inline backward move: group (" << groupStr << ") can move backward into "
-                << indexToNotation(backDest) << " (dir " << opp << " [" << DIRS[opp] << "])\n";
-            moves.push_back(mv);
+            ABALONE_TRACE(Trace::GROUP, "    Inline backward move: group (" << groupStr << ") can move backward into "
+                << indexToNotation(backDest) << " (dir " << opp << " [" << DIRS[opp] << "])");
+            pushUnique(moves, mv, seen);
         }
         else if (occupant[backDest] != occupant[group[0]]) { // opponent present
             if (group.size() == 2) {
                 bool canPush = true;
                 int current = backDest;
-                std::cout << "    Checking backward push for 2-marble group (" << groupStr
+                ABALONE_TRACE(Trace::CELL, "    Checking backward push for 2-marble group (" << groupStr
                     << ") in direction " << opp << " [" << DIRS[opp] << "], starting at "
-                    << indexToNotation(backDest) << "\n";
+                    << indexToNotation(backDest));
                 int nextChain = neighbors[current][opp];
-                std::cout << "      Push chain backward: " << indexToNotation(current)
-                    << " -> " << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board") << "\n";
-                if (nextChain < 0 || (nextChain >= 0 && occupant[nextChain] != Occupant::EMPTY)) {
+                ABALONE_TRACE(Trace::CELL, "      Push chain backward: " << indexToNotation(current)
+                    << " -> " << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board"));
+                if (nextChain >= 0 && occupant[nextChain] != Occupant::EMPTY) {
                     canPush = false;
-                    std::cout << "      Cannot push backward: destination "
+                    ABALONE_TRACE(Trace::CELL, "      Cannot push backward: destination "
                         << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board")
-                        << " is not empty.\n";
+                        << " is not empty.");
                 }
                 if (canPush) {
                     Move mv;
@@ -214,8 +202,8 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
                     mv.direction = opp;
                     mv.isInline = true;
                     mv.pushCount = 1;
-                    std::cout << "    Backward push move generated for 2-marble group (" << groupStr << ")\n";
-                    moves.push_back(mv);
+                    ABALONE_TRACE(Trace::GROUP, "    Backward push move generated for 2-marble group (" << groupStr << ")");
+                    pushUnique(moves, mv, seen);
                 }
             }
             else if (group.size() == 3) {
@@ -228,9 +216,9 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
                     mv.direction = opp;
                     mv.isInline = true;
                     mv.pushCount = 1;
-                    std::cout << "    Backward push move generated for 3-marble group (" << groupStr
-                        << ") pushing one marble\n";
-                    moves.push_back(mv);
+                    ABALONE_TRACE(Trace::GROUP, "    Backward push move generated for 3-marble group (" << groupStr
+                        << ") pushing one marble");
+                    pushUnique(moves, mv, seen);
                 }
                 // --- Case 2: Push two opponent marbles backward ---
                 if (backDest >= 0 && occupant[backDest] != Occupant::EMPTY && occupant[backDest] != occupant[group[0]]) {
@@ -244,9 +232,9 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
                             mv.direction = opp;
                             mv.isInline = true;
                             mv.pushCount = 2;
-                            std::cout << "    Backward push move generated for 3-marble group (" << groupStr
-                                << ") pushing two marbles\n";
-                            moves.push_back(mv);
+                            ABALONE_TRACE(Trace::GROUP, "    Backward push move generated for 3-marble group (" << groupStr
+                                << ") pushing two marbles");
+                            pushUnique(moves, mv, seen);
                         }
                     }
                 }
@@ -260,15 +248,15 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
         if (sd == d || sd == opp)
             continue;
         bool canSideStep = true;
-        std::cout << "    Checking side-step (dir " << sd << " [" << DIRS[sd]
-            << "]) for group (" << groupStr << ")\n";
+        ABALONE_TRACE(Trace::CELL, "    Checking side-step (dir " << sd << " [" << DIRS[sd]
+            << "]) for group (" << groupStr << ")");
             for (int cell : group) {
                 int dest = neighbors[cell][sd];
-                std::cout << "      " << indexToNotation(cell) << " -> "
-                    << (dest >= 0 ? indexToNotation(dest) : "off-board") << "\n";
+                ABALONE_TRACE(Trace::CELL, "      " << indexToNotation(cell) << " -> "
+                    << (dest >= 0 ? indexToNotation(dest) : "off-board"));
                 if (dest < 0 || occupant[dest] != Occupant::EMPTY) {
                     canSideStep = false;
-                    std::cout << "      Cannot side-step: destination not empty or off-board.\n";
+                    ABALONE_TRACE(Trace::CELL, "      Cannot side-step: destination not empty or off-board.");
                     break;
                 }
             }
@@ -277,72 +265,92 @@ void Board::generateGroupMoves(const std::vector<int>& group, int d, std::vector
                 mv.marbleIndices = group;
                 mv.direction = sd;
                 mv.isInline = false;
-                std::cout << "    Side-step move generated for group (" << groupStr
-                    << ") in direction " << sd << " [" << DIRS[sd] << "]\n";
-                moves.push_back(mv);
+                ABALONE_TRACE(Trace::GROUP, "    Side-step move generated for group (" << groupStr
+                    << ") in direction " << sd << " [" << DIRS[sd] << "]");
+                pushUnique(moves, mv, seen);
             }
     }
 }
 
 
-void Board::applyMove(const Move& m) {
-    if (m.marbleIndices.empty()) return;
+MoveUndo Board::applyMove(const Move& m) {
+    MoveUndo undo;
+    undo.previousToMove = nextToMove;
+    if (m.marbleIndices.empty()) return undo;
+    undo = makeUndo(CompactMove::fromMove(m));
+    if (undo.mover == Occupant::EMPTY)
+        return undo;   // first cell is empty: nothing to move
 
     int d = m.direction;
     static const char* DIRS[] = { "W", "E", "NW", "NE", "SW", "SE" };
 
-    std::cout << "Applying move: ";
-    std::cout << (occupant[m.marbleIndices[0]] == Occupant::BLACK ? "b" : "w")
-        << ", group (size " << m.marbleIndices.size() << "): ";
-    for (int idx : m.marbleIndices)
-        std::cout << indexToNotation(idx) << " ";
-    std::cout << ", direction: " << d << " (" << DIRS[d] << ")";
-    std::cout << (m.isInline ? " [inline]" : " [side-step]") << "\n";
+    if constexpr (Trace::enabled(Trace::MOVE)) {
+        std::string cells;
+        for (int idx : m.marbleIndices)
+            cells += indexToNotation(idx) + " ";
+        ABALONE_TRACE(Trace::MOVE, "Applying move: " << (undo.mover == Occupant::BLACK ? "b" : "w")
+            << ", group (size " << m.marbleIndices.size() << "): " << cells
+            << ", direction: " << d << " (" << DIRS[d] << ")" << (m.isInline ? " [inline]" : " [side-step]"));
+    }
 
     if (m.isInline) {
+        // Order the group back-to-front along d, so sortedGroup.back() is the leading marble.
+        // E, NW and NE increase the cell index; W, SW and SE decrease it.
         std::vector<int> sortedGroup = m.marbleIndices;
         std::sort(sortedGroup.begin(), sortedGroup.end());
+        bool increasing = (d == 1 || d == 2 || d == 3);
+        if (!increasing)
+            std::reverse(sortedGroup.begin(), sortedGroup.end());
         int front = sortedGroup.back();
         int dest = neighbors[front][d];
-        std::cout << "  Front cell: " << indexToNotation(front)
-            << ", destination: " << (dest >= 0 ? indexToNotation(dest) : "off-board") << "\n";
+        ABALONE_TRACE(Trace::MOVE, "  Front cell: " << indexToNotation(front)
+            << ", destination: " << (dest >= 0 ? indexToNotation(dest) : "off-board"));
 
         // Handle pushing if necessary.
         if (dest >= 0 && occupant[dest] != Occupant::EMPTY && occupant[dest] != occupant[front]) {
             // Use m.pushCount if set (otherwise default as before).
             int pushLimit = (m.pushCount > 0 ? m.pushCount : (sortedGroup.size() == 2 ? 1 : 2));
+            ABALONE_TRACE(Trace::MOVE, "  Push detected starting at " << indexToNotation(dest));
+
+            // Collect the opponent marbles being pushed, nearest first.
+            std::vector<int> chain;
             int current = dest;
-            std::cout << "  Push detected starting at " << indexToNotation(dest) << "\n";
-            for (int j = 0; j < pushLimit; j++) {
-                int nextChain = neighbors[current][d];
-                std::cout << "    Pushing: " << indexToNotation(current)
-                    << " -> " << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board") << "\n";
-                if (nextChain >= 0 && occupant[nextChain] == Occupant::EMPTY) {
+            while ((int)chain.size() < pushLimit && current >= 0
+                && occupant[current] != Occupant::EMPTY && occupant[current] != occupant[front]) {
+                chain.push_back(current);
+                current = neighbors[current][d];
+            }
+            if (current >= 0 && occupant[current] != Occupant::EMPTY) {
+                ABALONE_TRACE(Trace::MOVE, "    Push failed; move aborted.");
+                undo = MoveUndo();
+                undo.previousToMove = nextToMove;
+                return undo;
+            }
+
+            // Shift the chain starting from the far end so no marble lands on an occupied cell.
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+                int nextChain = neighbors[*it][d];
+                ABALONE_TRACE(Trace::MOVE, "    Pushing: " << indexToNotation(*it)
+                    << " -> " << (nextChain >= 0 ? indexToNotation(nextChain) : "off-board"));
+                if (nextChain >= 0) {
                     // Move the opponent marble one cell forward.
-                    occupant[nextChain] = occupant[current];
-                    occupant[current] = Occupant::EMPTY;
-                    current = nextChain;
+                    occupant[nextChain] = occupant[*it];
                 }
-                else if (nextChain < 0) {
+                else {
                     // Marble is pushed off the board.
-                    occupant[current] = Occupant::EMPTY;
-                    std::cout << "    Marble pushed off the board from " << indexToNotation(current)
-                        << ". This marble is now removed from play.\n";
+                    ABALONE_TRACE(Trace::MOVE, "    Marble pushed off the board from " << indexToNotation(*it)
+                        << ". This marble is now removed from play.");
                     // (If you are tracking counts explicitly, decrement the opponent’s count here.)
-                    break;
-                }
-                else {
-                    std::cout << "    Push failed; move aborted.\n";
-                    return;
                 }
+                occupant[*it] = Occupant::EMPTY;
             }
         }
         // Move own marbles from front to back.
         for (auto it = sortedGroup.rbegin(); it != sortedGroup.rend(); ++it) {
             int idx = *it;
             int target = neighbors[idx][d];
-            std::cout << "  Moving " << indexToNotation(idx) << " to "
-                << (target >= 0 ? indexToNotation(target) : "off-board") << "\n";
+            ABALONE_TRACE(Trace::MOVE, "  Moving " << indexToNotation(idx) << " to "
+                << (target >= 0 ? indexToNotation(target) : "off-board"));
             if (target >= 0 && occupant[target] == Occupant::EMPTY) {
                 occupant[target] = occupant[idx];
                 occupant[idx] = Occupant::EMPTY;
@@ -353,142 +361,476 @@ void Board::applyMove(const Move& m) {
         // Side-step moves: move each marble individually.
         for (int idx : m.marbleIndices) {
             int target = neighbors[idx][d];
-            std::cout << "  Side-stepping " << indexToNotation(idx) << " to "
-                << (target >= 0 ? indexToNotation(target) : "off-board") << "\n";
+            ABALONE_TRACE(Trace::MOVE, "  Side-stepping " << indexToNotation(idx) << " to "
+                << (target >= 0 ? indexToNotation(target) : "off-board"));
             if (target >= 0 && occupant[target] == Occupant::EMPTY) {
                 occupant[target] = occupant[idx];
                 occupant[idx] = Occupant::EMPTY;
             }
         }
     }
-}
-
 
+    nextToMove = (undo.mover == Occupant::BLACK ? Occupant::WHITE : Occupant::BLACK);
+    toggleMoveHash(undo);
+    features = computeFeatures();   // reference path: rescan rather than replay the move
+    checkHash();
+    return undo;
+}
 
-std::string Board::moveToNotation(const Move& m, Occupant side) {
-    std::string notation;
-    char teamChar = (side == Occupant::BLACK ? 'b' : 'w');
+//========================== 0b) Allocation-free move logic ==========================//
 
-    // Create a vector of cell notations for each index in the move.
-    std::vector<std::string> cellNotations;
+CompactMove CompactMove::fromMove(const Move& m) {
+    std::array<int, 3> sorted = { NO_CELL, NO_CELL, NO_CELL };
+    int n = 0;
     for (int idx : m.marbleIndices) {
-        cellNotations.push_back(indexToNotation(idx));
+        if (n < 3)
+            sorted[n++] = idx;
     }
+    // Insertion sort; at most three entries
+    for (int x = 1; x < n; x++)
+        for (int y = x; y > 0 && sorted[y - 1] > sorted[y]; y--)
+            std::swap(sorted[y - 1], sorted[y]);
+    return CompactMove(sorted[0], sorted[1], sorted[2], n, m.direction, m.isInline, m.pushCount);
+}
 
-    // Sort in descending order (so that, e.g., F3, E3, D3 appear)
-    std::sort(cellNotations.begin(), cellNotations.end(), std::greater<std::string>());
+Move CompactMove::toMove() const {
+    Move m;
+    for (int k = 0; k < size(); k++)
+        m.marbleIndices.push_back(cells[k]);
+    m.direction = direction();
+    m.isInline = isInline();
+    m.pushCount = pushCount();
+    return m;
+}
 
-    // Build the notation string.
-    notation = "(";
-    notation.push_back(teamChar);
-    notation += ", ";
+uint64_t Board::occupancyMask(Occupant side) const {
+    uint64_t mask = 0;
+    for (int i = 0; i < NUM_CELLS; i++)
+        mask |= uint64_t(occupant[i] == side) << i;
+    return mask;
+}
 
-    // Append each cell coordinate separated by commas.
-    for (size_t i = 0; i < cellNotations.size(); i++) {
-        if (i > 0)
-            notation += ", ";
-        notation += cellNotations[i];
+// Same move set as generateMoves(Occupant), without tracing or heap allocation.
+// Moves are appended to 'moves'.
+void Board::generateMoves(Occupant side, MoveList& moves) const {
+    if (side == Occupant::WHITE)
+        generateMovesFor<Occupant::WHITE>(moves);
+    else
+        generateMovesFor<Occupant::BLACK>(moves);
+}
+
+void Board::generatePushes(Occupant side, MoveList& moves) const {
+    if (side == Occupant::WHITE)
+        generateMovesFor<Occupant::WHITE, GEN_PUSHES>(moves);
+    else
+        generateMovesFor<Occupant::BLACK, GEN_PUSHES>(moves);
+}
+
+void Board::generateQuietMoves(Occupant side, MoveList& moves) const {
+    if (side == Occupant::WHITE)
+        generateMovesFor<Occupant::WHITE, GEN_QUIET>(moves);
+    else
+        generateMovesFor<Occupant::BLACK, GEN_QUIET>(moves);
+}
+
+void Board::generateCaptures(Occupant side, MoveList& moves) const {
+    if (side == Occupant::WHITE)
+        generateMovesFor<Occupant::WHITE, GEN_CAPTURES>(moves);
+    else
+        generateMovesFor<Occupant::BLACK, GEN_CAPTURES>(moves);
+}
+
+// Cells on the outer ring: only a marble here can be pushed off the board
+static constexpr uint64_t buildRimMask() {
+    uint64_t mask = 0;
+    for (int i = 0; i < Board::NUM_CELLS; i++)
+        if (Board::s_centreDistance[i] == 4)
+            mask |= uint64_t(1) << i;
+    return mask;
+}
+static constexpr uint64_t RIM_MASK = buildRimMask();
+
+template <Occupant Side, int Kinds>
+void Board::generateMovesFor(MoveList& moves) const {
+    constexpr Occupant Opp = opponentOf(Side);
+    MoveKeySet seen;
+    uint64_t own = 0, opp = 0;
+    for (int i = 0; i < NUM_CELLS; i++) {
+        own |= uint64_t(occupant[i] == Side) << i;
+        opp |= uint64_t(occupant[i] == Opp) << i;
+    }
+    const uint64_t occupied = own | opp;
+    if constexpr (Kinds == GEN_CAPTURES) {
+        if (!(opp & RIM_MASK))
+            return;
     }
-    notation += ") ";
-    // 'i' for inline moves; 's' for side-step moves.
-    notation += (m.isInline ? "i" : "s");
-    notation += " → ";
 
-    static const char* DIRS[] = { "W", "E", "NW", "NE", "SW", "SE" };
-    notation += DIRS[m.direction];
+    for (uint64_t rest = own; rest; rest &= rest - 1) {
+        const int i = __builtin_ctzll(rest);
 
-    return notation;
+        // -------- 1. Single Marble Moves (never pushes) --------
+        if constexpr ((Kinds & GEN_QUIET) != 0) {
+            for (int d = 0; d < NUM_DIRECTIONS; d++) {
+                int nIdx = neighbors[i][d];
+                if (nIdx >= 0 && !((occupied >> nIdx) & 1))
+                    pushUnique(moves, CompactMove(i, CompactMove::NO_CELL, CompactMove::NO_CELL, 1, d, true, 0), seen);
+            }
+        }
+
+        // -------- 2. Two- and Three-Marble Groups: every table line starting at i that we fill --------
+        for (int l = s_lines.firstLine[i]; l < s_lines.firstLine[i + 1]; l++) {
+            const HexTopology::Line& line = s_lines.lines[l];
+            if ((line.mask & own) == line.mask)
+                generateLineMoves<Kinds>(line, own, opp, moves, seen);
+        }
+    }
 }
 
+template <int Kinds>
+void Board::generateLineMoves(const HexTopology::Line& line, uint64_t own, uint64_t opp,
+    MoveList& moves, MoveKeySet& seen) {
+    const int size = line.size;
+    const int a = line.cells[0], b = line.cells[1];
+    const int c = (size == 3) ? line.cells[2] : CompactMove::NO_CELL;
+    const uint64_t occupied = own | opp;
+    auto isOpp = [&](int cell) { return (opp >> cell) & 1; };
+    auto isEmpty = [&](int cell) { return !((occupied >> cell) & 1); };
+
+    // ---- Inline Moves: forward off the front marble, backward off the back marble ----
+    const int dirs[2] = { line.axis, OPPOSITE_DIRECTION[line.axis] };
+    for (int e = 0; e < 2; e++) {
+        const auto& ahead = line.ahead[e];
+        int dest = ahead[0];
+        if (dest < 0 || ((own >> dest) & 1))
+            continue;
+        if (isEmpty(dest)) {
+            if constexpr ((Kinds & GEN_QUIET) != 0)
+                pushUnique(moves, CompactMove(a, b, c, size, dirs[e], true, 0), seen);
+            continue;
+        }
+        if constexpr ((Kinds & (GEN_PUSHES | GEN_CAPTURES)) == 0)
+            continue;
 
+        // Sumito: fewer opponent marbles than ours, followed by an empty cell or the edge
+        // (only the edge when just captures are wanted).
+        int pushed = 0;
+        while (pushed < size && ahead[pushed] >= 0 && isOpp(ahead[pushed]))
+            pushed++;
+        if constexpr ((Kinds & GEN_PUSHES) == 0) {
+            if (pushed < size && ahead[pushed] < 0)
+                pushUnique(moves, CompactMove(a, b, c, size, dirs[e], true, pushed), seen);
+        } else {
+            if (pushed < size && (ahead[pushed] < 0 || isEmpty(ahead[pushed])))
+                pushUnique(moves, CompactMove(a, b, c, size, dirs[e], true, pushed), seen);
+        }
+    }
 
-std::string Board::toBoardString() const {
-    // Gather occupant positions
-    // We'll store them in two vectors: blackCells, whiteCells
-    std::vector<std::string> blackCells;
-    std::vector<std::string> whiteCells;
+    // ---- Side-Step Moves: all destinations on the board and empty ----
+    if constexpr ((Kinds & GEN_QUIET) != 0) {
+        for (int sd = 0; sd < NUM_DIRECTIONS; sd++) {
+            if (((line.sideValid >> sd) & 1) && !(line.sideMask[sd] & occupied))
+                pushUnique(moves, CompactMove(a, b, c, size, sd, false, 0), seen);
+        }
+    }
+}
+
+bool Board::ejects(const CompactMove& m) {
+    const int n = m.size();
+    if (n == 0 || m.pushCount() == 0)
+        return false;
+    // The pushed marbles fill the ray ahead of the front marble; ejection means the ray ends there
+    const int d = m.direction();
+    const bool increasing = (d == 1 || d == 2 || d == 3);
+    const int front = increasing ? m.cells[n - 1] : m.cells[0];
+    return rays[front][d].length == m.pushCount();
+}
 
+bool Board::isLegal(const CompactMove& m) const {
+    const int n = m.size();
+    if (n == 0 || m.cells[0] >= NUM_CELLS || m.direction() >= NUM_DIRECTIONS)
+        return false;
+    const Occupant side = nextToMove;
+    uint64_t own = 0, opp = 0;
     for (int i = 0; i < NUM_CELLS; i++) {
-        if (occupant[i] == Occupant::BLACK) {
-            blackCells.push_back(indexToNotation(i) + "b");
-        }
-        else if (occupant[i] == Occupant::WHITE) {
-            whiteCells.push_back(indexToNotation(i) + "w");
+        own |= uint64_t(occupant[i] == side) << i;
+        opp |= uint64_t(occupant[i] == opponentOf(side)) << i;
+    }
+
+    // Regenerate only the moves of m's own group and look for m among them
+    MoveList candidates;
+    MoveKeySet seen;
+    if (n == 1) {
+        const int i = m.cells[0];
+        const int dest = neighbors[i][m.direction()];
+        return ((own >> i) & 1) && dest >= 0 && !(((own | opp) >> dest) & 1)
+            && m == CompactMove(i, CompactMove::NO_CELL, CompactMove::NO_CELL, 1, m.direction(), true, 0);
+    }
+    for (int l = s_lines.firstLine[m.cells[0]]; l < s_lines.firstLine[m.cells[0] + 1]; l++) {
+        const HexTopology::Line& line = s_lines.lines[l];
+        if (line.size == n && line.cells[1] == m.cells[1] && (line.mask & own) == line.mask) {
+            generateLineMoves(line, own, opp, candidates, seen);
+            break;
         }
     }
+    for (const CompactMove& c : candidates)
+        if (c == m)
+            return true;
+    return false;
+}
 
-    // Sort each vector. 
-    // The notation "A1", "A2", ... "B1" etc. is alphabetical by letter then numeric by col
-    // If your indexToNotation already returns "A1", "B2" in the correct style, 
-    // you can just do a lexicographical sort.
-    auto cmp = [](const std::string& a, const std::string& b) {
-        return a < b; // simple lex order: A2b < A10b, careful with single vs double digit
-        };
-    std::sort(blackCells.begin(), blackCells.end(), cmp);
-    std::sort(whiteCells.begin(), whiteCells.end(), cmp);
+std::atomic<uint64_t> Board::s_duplicateMoves{ 0 };
 
-    // Combine them (black first, then white)
-    std::vector<std::string> all;
-    all.reserve(blackCells.size() + whiteCells.size());
-    for (auto& bc : blackCells) all.push_back(bc);
-    for (auto& wc : whiteCells) all.push_back(wc);
+int Board::moveKey(const CompactMove& m) {
+    int shape = 0;
+    if (m.size() >= 2) {
+        int axis = 1;   // E, NW or NE: the direction from the lowest cell to the next one
+        while (axis < 3 && neighbors[m.cells[0]][axis] != m.cells[1])
+            axis++;
+        shape = (m.size() == 3 ? 3 : 0) + axis;
+    }
+    return (m.cells[0] * 7 + shape) * NUM_DIRECTIONS + m.direction();
+}
 
-    // Join them with commas
-    std::string result;
-    for (size_t i = 0; i < all.size(); i++) {
-        if (i > 0) result += ",";
-        result += all[i];
+void Board::pushUnique(std::vector<Move>& moves, const Move& m, MoveKeySet& seen) {
+    if (seen.insert(moveKey(CompactMove::fromMove(m))))
+        moves.push_back(m);
+    else
+        s_duplicateMoves.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Board::pushUnique(MoveList& moves, const CompactMove& m, MoveKeySet& seen) {
+    if (seen.insert(moveKey(m)))
+        moves.push_back(m);
+    else
+        s_duplicateMoves.fetch_add(1, std::memory_order_relaxed);
+}
+
+MoveUndo Board::makeUndo(const CompactMove& m) const {
+    if (m.size() > 0 && occupant[m.cells[0]] == Occupant::WHITE)
+        return makeUndoFor<Occupant::WHITE>(m);
+    if (m.size() > 0 && occupant[m.cells[0]] == Occupant::BLACK)
+        return makeUndoFor<Occupant::BLACK>(m);
+    // No marble to move: a rejected move. Its undo records an empty move, so undoMove
+    // and toggleMoveHash leave the board exactly as it is.
+    MoveUndo undo;
+    undo.previousToMove = nextToMove;
+    undo.previousFeatures = features;
+    return undo;
+}
+
+template <Occupant Side>
+MoveUndo Board::makeUndoFor(const CompactMove& m) const {
+    MoveUndo undo;
+    undo.move = m;
+    undo.previousToMove = nextToMove;
+    undo.previousFeatures = features;
+    const int n = m.size();
+    if (n == 0)
+        return undo;
+    undo.mover = Side;
+    if (!m.isInline())
+        return undo;
+
+    // cells[] is ascending and E, NW, NE increase the index, so that picks the front marble.
+    const int d = m.direction();
+    const bool increasing = (d == 1 || d == 2 || d == 3);
+    int current = neighbors[increasing ? m.cells[n - 1] : m.cells[0]][d];
+
+    // Record the opponent marbles in front of the group; a legal push has fewer than n of them.
+    while (current >= 0 && undo.pushedCount < n - 1 && occupant[current] == opponentOf(Side)) {
+        undo.pushed[undo.pushedCount++] = uint8_t(current);
+        current = neighbors[current][d];
     }
+    if (undo.pushedCount > 0 && current < 0)
+        undo.ejected = undo.pushed[undo.pushedCount - 1];
+    return undo;
+}
 
-    return result;
+MoveUndo Board::applyMove(const CompactMove& m) {
+    if (m.size() > 0 && occupant[m.cells[0]] == Occupant::WHITE)
+        return applyMoveFor<Occupant::WHITE>(m);
+    if (m.size() > 0 && occupant[m.cells[0]] == Occupant::BLACK)
+        return applyMoveFor<Occupant::BLACK>(m);
+    return makeUndo(m);
 }
 
-// Helper: index -> e.g. "C5"
-std::string Board::indexToNotation(int idx) {
-    // s_indexToCoord[idx] => (m, y)
-    auto [m, y] = s_indexToCoord[idx];
-    // y => 'A' + (y-1)
-    char rowLetter = char('A' + (y - 1));
-    // col = m
+template <Occupant Side>
+MoveUndo Board::applyMoveFor(const CompactMove& m) {
+    MoveUndo undo = makeUndoFor<Side>(m);
+    const int n = m.size();
+    if (n == 0) return undo;
+    ABALONE_TRACE(Trace::MOVE, "Applying move: " << moveToNotation(m, Side)
+        << (undo.ejected != CompactMove::NO_CELL ? " ejects " + indexToNotation(undo.ejected) : ""));
+
+    const int d = m.direction();
+
+    // Shift the pushed chain from the far end; a marble with no neighbor leaves the board
+    // (lifted and not placed again, which is what counts it as lost in features).
+    for (int k = undo.pushedCount - 1; k >= 0; k--) {
+        int cell = undo.pushed[k];
+        int next = neighbors[cell][d];
+        liftMarble(cell);
+        if (next >= 0)
+            placeMarble(next, opponentOf(Side));
+    }
+
+    // Lift the whole group, then drop it one step along d (works for inline and side-step).
+    for (int k = 0; k < n; k++)
+        liftMarble(m.cells[k]);
+    for (int k = 0; k < n; k++)
+        placeMarble(neighbors[m.cells[k]][d], Side);
+
+    nextToMove = opponentOf(Side);
+    toggleMoveHash(undo);
+    checkHash();
+    checkFeatures();
+    return undo;
+}
+
+// The two colours the side-specialised cores are built for
+template void Board::generateMovesFor<Occupant::BLACK>(MoveList&) const;
+template void Board::generateMovesFor<Occupant::WHITE>(MoveList&) const;
+template void Board::generateMovesFor<Occupant::BLACK, Board::GEN_PUSHES>(MoveList&) const;
+template void Board::generateMovesFor<Occupant::WHITE, Board::GEN_PUSHES>(MoveList&) const;
+template void Board::generateMovesFor<Occupant::BLACK, Board::GEN_QUIET>(MoveList&) const;
+template void Board::generateMovesFor<Occupant::WHITE, Board::GEN_QUIET>(MoveList&) const;
+template void Board::generateMovesFor<Occupant::BLACK, Board::GEN_CAPTURES>(MoveList&) const;
+template void Board::generateMovesFor<Occupant::WHITE, Board::GEN_CAPTURES>(MoveList&) const;
+template MoveUndo Board::applyMoveFor<Occupant::BLACK>(const CompactMove&);
+template MoveUndo Board::applyMoveFor<Occupant::WHITE>(const CompactMove&);
+
+void Board::undoMove(const MoveUndo& undo) {
+    const CompactMove& m = undo.move;
+    const int n = m.size();
+    const int d = m.direction();
+    const Occupant opponent = opponentOf(undo.mover);
+
+    // Clear every destination first: the group's new cells overlap its old cells
+    // and the first pushed marble's old cell, so restoring comes afterwards.
+    for (int k = 0; k < n; k++)
+        occupant[neighbors[m.cells[k]][d]] = Occupant::EMPTY;
+    for (int k = 0; k < undo.pushedCount; k++) {
+        int next = neighbors[undo.pushed[k]][d];
+        if (next >= 0)
+            occupant[next] = Occupant::EMPTY;
+    }
 
-    // Build string, e.g. "C5"
+    for (int k = 0; k < undo.pushedCount; k++)
+        occupant[undo.pushed[k]] = opponent;
+    for (int k = 0; k < n; k++)
+        occupant[m.cells[k]] = undo.mover;
+
+    toggleMoveHash(undo);
+    nextToMove = undo.previousToMove;
+    if (n > 0)
+        features = undo.previousFeatures;   // a rejected move changed nothing
+    checkHash();
+    checkFeatures();
+}
+
+void Board::toggleMoveHash(const MoveUndo& undo) {
+    const CompactMove& m = undo.move;
+    if (m.size() == 0) return;   // rejected move: nothing changed
+    const int d = m.direction();
+    const Occupant opponent = opponentOf(undo.mover);
+
+    uint64_t delta = zobristSide(undo.previousToMove) ^ zobristSide(opponent);
+    for (int k = 0; k < m.size(); k++) {
+        delta ^= zobristKey(m.cells[k], undo.mover);
+        delta ^= zobristKey(neighbors[m.cells[k]][d], undo.mover);
+    }
+    // Pushed marbles move one step too; an ejected one only leaves its cell.
+    for (int k = 0; k < undo.pushedCount; k++) {
+        delta ^= zobristKey(undo.pushed[k], opponent);
+        int next = neighbors[undo.pushed[k]][d];
+        if (next >= 0)
+            delta ^= zobristKey(next, opponent);
+    }
+    hash ^= delta;
+}
+
+std::string Board::moveToNotation(const Move& m, Occupant side) {
+    return moveToNotation(CompactMove::fromMove(m), side);
+}
+
+std::string Board::moveToNotation(const CompactMove& m, Occupant side) {
     std::string notation;
-    notation.push_back(rowLetter);
-    notation += std::to_string(m);
+    appendMoveNotation(notation, m, side);
     return notation;
 }
 
+void Board::appendMoveNotation(std::string& out, const CompactMove& m, Occupant side) {
+    static const char* DIRS[] = { "W", "E", "NW", "NE", "SW", "SE" };
+
+    out += '(';
+    out += (side == Occupant::BLACK ? 'b' : 'w');
+    // Cells are listed in descending notation order (e.g. F3, E3, D3); cells[] is
+    // ascending by index, which is the same as ascending notation.
+    for (int k = m.size() - 1; k >= 0; k--) {
+        out += ", ";
+        out.append(s_cellNotation[m.cells[k]].data(), 2);
+    }
+    out += ") ";
+    // 'i' for inline moves; 's' for side-step moves.
+    out += (m.isInline() ? "i" : "s");
+    out += " → ";
+    out += DIRS[m.direction()];
+}
+
+std::string Board::toBoardString() const {
+    std::string result;
+    result.reserve(NUM_CELLS * 4);
+    appendBoardString(result);
+    return result;
+}
+
+void Board::appendBoardString(std::string& out) const {
+    // Black first, then white, each in notation order - which is index order
+    // (see HexTopology::indexOrderIsLexicographic), so a single pass per colour.
+    bool first = true;
+    for (Occupant who : { Occupant::BLACK, Occupant::WHITE }) {
+        const char colour = (who == Occupant::BLACK ? 'b' : 'w');
+        for (int i = 0; i < NUM_CELLS; i++) {
+            if (occupant[i] != who)
+                continue;
+            if (!first)
+                out += ',';
+            first = false;
+            const char token[3] = { s_cellNotation[i][0], s_cellNotation[i][1], colour };
+            out.append(token, 3);
+        }
+    }
+}
+
+// Helper: index -> e.g. "C5"
+std::string Board::indexToNotation(int idx) {
+    return std::string(s_cellNotation[idx].data(), 2);
+}
+
 
 
 //========================== 1) HARDCODED LAYOUTS ==========================//
 
 void Board::initStandardLayout() {
     occupant.fill(Occupant::EMPTY);
+    nextToMove = Occupant::BLACK;
+    refreshIncremental();
 
-    // Example squares for the "standard" arrangement.
-    // This is just a sample list. Replace with the actual squares for a real standard setup.
-    // Usually black is at top rows, white at bottom, etc.
-
-    // Hardcode black squares:
+    // Standard start: each side fills its two edge rows and the middle three cells of
+    // the third row. Black moves first.
     std::vector<std::string> blackPositions = {
-        // For example:
-        "A4", "A5",
-        "B4", "B5", "B6",
-        "C4", "C5", "C6", "C7",
-        "D5", "D6", "D7",
-        "E5", "E6"
+        "A1", "A2", "A3", "A4", "A5",
+        "B1", "B2", "B3", "B4", "B5", "B6",
+        "C3", "C4", "C5"
     };
     for (auto& cell : blackPositions) {
         setOccupant(cell, Occupant::BLACK);
     }
 
-    // Hardcode white squares:
     std::vector<std::string> whitePositions = {
-        // For example:
-        "E4", "F4", "F5", "F6", "F7",
-        "G3", "G4", "G5", "G6", "G7",
-        "H4", "H5", "H6",
-        "I5"
+        "I5", "I6", "I7", "I8", "I9",
+        "H4", "H5", "H6", "H7", "H8", "H9",
+        "G5", "G6", "G7"
     };
     for (auto& cell : whitePositions) {
         setOccupant(cell, Occupant::WHITE);
@@ -497,23 +839,22 @@ void Board::initStandardLayout() {
 
 void Board::initBelgianDaisyLayout() {
     occupant.fill(Occupant::EMPTY);
+    nextToMove = Occupant::BLACK;
+    refreshIncremental();
 
-    // Example squares for Belgian Daisy arrangement.
-    // Replace with the official squares from your reference.
-
-    // Black
+    // Belgian Daisy: two 7-marble "daisies" per side in opposite corners, each side's
+    // daisy next to one of the opponent's along the bottom and top edges.
     std::vector<std::string> blackPositions = {
-        "C5","C6","D4","D7","E4","E7","F4","F7","G5","G6"
-        // Add the rest to total 14 black marbles
+        "A1", "A2", "B1", "B2", "B3", "C2", "C3",
+        "G7", "G8", "H7", "H8", "H9", "I8", "I9"
     };
     for (auto& cell : blackPositions) {
         setOccupant(cell, Occupant::BLACK);
     }
 
-    // White
     std::vector<std::string> whitePositions = {
-        "C4","D3","E3","F3","G4","G7","D8","E8","F8","G8"
-        // Add the rest to total 14 white marbles
+        "A4", "A5", "B4", "B5", "B6", "C5", "C6",
+        "G4", "G5", "H4", "H5", "H6", "I5", "I6"
     };
     for (auto& cell : whitePositions) {
         setOccupant(cell, Occupant::WHITE);
@@ -522,24 +863,22 @@ void Board::initBelgianDaisyLayout() {
 
 void Board::initGermanDaisyLayout() {
     occupant.fill(Occupant::EMPTY);
+    nextToMove = Occupant::BLACK;
+    refreshIncremental();
 
-    // Example squares for German Daisy arrangement.
-    // Replace with official squares.
-    // Typically forms a daisy shape offset differently from Belgian.
-
-    // Black
+    // German Daisy: the same daisies as Belgian, set one row further in, so none of
+    // them touches the top or bottom row.
     std::vector<std::string> blackPositions = {
-        "B4","C4","D5","E5","F5","G5","H6"
-        // ... etc. Fill up to 14
+        "B1", "B2", "C1", "C2", "C3", "D2", "D3",
+        "F7", "F8", "G7", "G8", "G9", "H8", "H9"
     };
     for (auto& cell : blackPositions) {
         setOccupant(cell, Occupant::BLACK);
     }
 
-    // White
     std::vector<std::string> whitePositions = {
-        "B5","C5","D4","E4","F4","G4","H5"
-        // ... etc. Fill up to 14
+        "B5", "B6", "C5", "C6", "C7", "D6", "D7",
+        "F3", "F4", "G3", "G4", "G5", "H4", "H5"
     };
     for (auto& cell : whitePositions) {
         setOccupant(cell, Occupant::WHITE);
@@ -552,73 +891,107 @@ void Board::initGermanDaisyLayout() {
 //   Line 1: single character 'b' or 'w'
 //   Line 2: comma-separated "A5b,D5b,E4b,E5b,..."
 //
-bool Board::loadFromInputFile(const std::string& filename) {
-    occupant.fill(Occupant::EMPTY);
+// Parsing lives in PositionReader, which scans the memory-mapped file in place.
+//
+static bool loadFromReader(Board& board, PositionReader& reader, const char* source) {
+    switch (reader.next(board)) {
+    case PositionReader::OK:
+        if (reader.skippedTokens() > 0)
+            std::cerr << "Warning: skipped " << reader.skippedTokens()
+                << " invalid marble token(s) in " << source << "\n";
+        return true;
+    case PositionReader::END:
+        std::cerr << "Error: " << source << " is missing the first line.\n";
+        break;
+    case PositionReader::BAD_SIDE:
+        std::cerr << "Error: first line of " << source << " must be 'b' or 'w'.\n";
+        break;
+    case PositionReader::MISSING_MARBLES:
+        std::cerr << "Error: " << source << " is missing the second line.\n";
+        break;
+    case PositionReader::TOO_MANY_MARBLES:
+        std::cerr << "Error: " << source << " has more than " << Board::START_MARBLES
+            << " marbles of one colour.\n";
+        break;
+    }
+    board.unpack(PackedPosition());
+    return false;
+}
 
-    std::ifstream fin(filename);
-    if (!fin.is_open()) {
+bool Board::loadFromInputFile(const std::string& filename) {
+    PositionReader reader(filename);
+    if (!reader.isOpen()) {
+        unpack(PackedPosition());
         std::cerr << "Error: could not open file: " << filename << "\n";
         return false;
     }
+    return loadFromReader(*this, reader, filename.c_str());
+}
 
-    // 1) Read the color of the marbles to move next
-    std::string line;
-    if (!std::getline(fin, line)) {
-        std::cerr << "Error: file is missing the first line.\n";
-        return false;
-    }
-    if (line.size() < 1) {
-        std::cerr << "Error: first line is empty.\n";
-        return false;
+bool Board::loadFromStream(std::istream& fin) {
+    // Only the two lines of one record are needed; scan them from a local buffer
+    std::string text, line;
+    while (std::getline(fin, line)) {
+        if (text.empty() && line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;   // blank lines before the record
+        text += line;
+        text += '\n';
+        if (text.size() > line.size() + 1)
+            break;      // side line and marble line both read
     }
+    PositionReader reader(text.data(), text.data() + text.size());
+    return loadFromReader(*this, reader, "input");
+}
 
-    char nextColorChar = line[0];
-    if (nextColorChar == 'b' || nextColorChar == 'B') {
-        nextToMove = Occupant::BLACK;
-    }
-    else if (nextColorChar == 'w' || nextColorChar == 'W') {
-        nextToMove = Occupant::WHITE;
-    }
-    else {
-        std::cerr << "Error: first line must be 'b' or 'w'. Found: " << line << "\n";
-        return false;
-    }
+PackedPosition Board::pack() const {
+    PackedPosition pos;
+    pos.black = occupancyMask(Occupant::BLACK);
+    pos.white = occupancyMask(Occupant::WHITE);
+    pos.toMove = nextToMove;
+    return pos;
+}
 
-    // 2) Read the second line with positions
-    if (!std::getline(fin, line)) {
-        std::cerr << "Error: file is missing the second line.\n";
-        return false;
+PackedPosition Board::packAfter(const PackedPosition& current, const CompactMove& m) const {
+    PackedPosition next = current;
+    const int n = m.size();
+    if (n == 0)
+        return next;
+    const MoveUndo undo = makeUndo(m);
+    if (undo.move.size() == 0)
+        return next;   // no marble on the first cell, as applyMove
+    const int d = m.direction();
+    uint64_t& own = (undo.mover == Occupant::BLACK) ? next.black : next.white;
+    uint64_t& opp = (undo.mover == Occupant::BLACK) ? next.white : next.black;
+
+    // Clear every source before setting destinations: they overlap along d
+    uint64_t from = 0, to = 0;
+    for (int k = 0; k < n; k++) {
+        from |= uint64_t(1) << m.cells[k];
+        to |= uint64_t(1) << neighbors[m.cells[k]][d];
     }
-    // line might be e.g. "C5b,D5b,E4b,E5b,E6b..."
-
-    // We'll split by commas
-    std::stringstream ss(line);
-    std::string token;
-    while (std::getline(ss, token, ',')) {
-        // token e.g. "C5b" or "D5b"
-        // trim whitespace if any
-        if (token.empty()) continue;
-
-        // The last character is color: 'b' or 'w'
-        char c = token.back();
-        Occupant who;
-        if (c == 'b' || c == 'B') who = Occupant::BLACK;
-        else if (c == 'w' || c == 'W') who = Occupant::WHITE;
-        else {
-            std::cerr << "Warning: token '" << token << "' does not end in b/w. Skipping.\n";
-            continue;
-        }
+    own = (own & ~from) | to;
+
+    from = to = 0;
+    for (int k = 0; k < undo.pushedCount; k++) {
+        from |= uint64_t(1) << undo.pushed[k];
+        int dest = neighbors[undo.pushed[k]][d];
+        if (dest >= 0)
+            to |= uint64_t(1) << dest;
+    }
+    opp = (opp & ~from) | to;
 
-        // remove that last character from the token so only e.g. "C5" remains
-        token.pop_back();
+    next.toMove = opponentOf(undo.mover);
+    return next;
+}
 
-        // token should now be "C5", "D5", etc.
-        // set occupant
-        setOccupant(token, who);
+void Board::unpack(const PackedPosition& pos) {
+    for (int i = 0; i < NUM_CELLS; i++) {
+        const uint64_t bit = uint64_t(1) << i;
+        occupant[i] = (pos.black & bit) ? Occupant::BLACK
+            : (pos.white & bit) ? Occupant::WHITE : Occupant::EMPTY;
     }
-
-    fin.close();
-    return true;
+    nextToMove = pos.toMove;
+    refreshIncremental();
 }
 
 //========================== 3) setOccupant & utility ==========================//
@@ -626,7 +999,7 @@ bool Board::loadFromInputFile(const std::string& filename) {
 void Board::setOccupant(const std::string& notation, Occupant who) {
     int idx = notationToIndex(notation);
     if (idx >= 0) {
-        occupant[idx] = who;
+        setOccupant(idx, who);
     }
     else {
         std::cerr << "Warning: invalid cell notation '" << notation << "'\n";
@@ -635,82 +1008,50 @@ void Board::setOccupant(const std::string& notation, Occupant who) {
 
 //========================== 4) THE REST (mapping, neighbors, etc.) ==========================//
 
-bool Board::s_mappingInitialized = false;
-std::unordered_map<long long, int> Board::s_coordToIndex;
-std::array<std::pair<int, int>, Board::NUM_CELLS> Board::s_indexToCoord;
-
-static long long packCoord(int m, int y)
-{
-    // Combine (m,y) into a single 64-bit
-    return (static_cast<long long>(m) << 32) ^ (static_cast<long long>(y) & 0xffffffff);
-}
-
-void Board::initMapping()
-{
-    if (s_mappingInitialized) return;
-    s_mappingInitialized = true;
-    s_coordToIndex.clear();
-
-    int idx = 0;
-    for (int y = 1; y <= 9; ++y) {
-        for (int m = 1; m <= 9; ++m) {
-            bool validCell = false;
-            switch (y)
-            {
-            case 1: validCell = (m >= 1 && m <= 5); break; // A1..A5
-            case 2: validCell = (m >= 1 && m <= 6); break; // B1..B6
-            case 3: validCell = (m >= 1 && m <= 7); break; // C1..C7
-            case 4: validCell = (m >= 1 && m <= 8); break; // D1..D8
-            case 5: validCell = (m >= 1 && m <= 9); break; // E1..E9
-            case 6: validCell = (m >= 2 && m <= 9); break; // F2..F9
-            case 7: validCell = (m >= 3 && m <= 9); break; // G3..G9
-            case 8: validCell = (m >= 4 && m <= 9); break; // H4..H9
-            case 9: validCell = (m >= 5 && m <= 9); break; // I5..I9
-            }
-
-            if (validCell) {
-                long long key = packCoord(m, y);
-                s_coordToIndex[key] = idx;
-                s_indexToCoord[idx] = { m, y };
-                ++idx;
-            }
-        }
-    }
-
-    if (idx != NUM_CELLS) {
-        throw std::runtime_error("Did not fill exactly 61 cells! Check your loops!");
-    }
+static_assert(Board::NUM_CELLS == HexTopology::NUM_CELLS, "board and topology disagree on cell count");
+static_assert(MoveList::MAX_MARBLES == Board::START_MARBLES, "MoveList is sized for the starting marble count");
+static constexpr bool oppositesAgree() {
+    for (int d = 0; d < Board::NUM_DIRECTIONS; d++)
+        if (HexTopology::oppositeOf(d) != Board::OPPOSITE_DIRECTION[d])
+            return false;
+    return true;
 }
+static_assert(oppositesAgree(), "topology and board disagree on opposite directions");
+static_assert(Board::NUM_CELLS <= 64, "occupancy masks hold one bit per cell");
+static_assert(MoveKeySet::NUM_KEYS == Board::NUM_CELLS * 7 * Board::NUM_DIRECTIONS, "move key range");
 
 Board::Board()
 {
-    initMapping();
     occupant.fill(Occupant::EMPTY);
-    initNeighbors();
+    refreshIncremental();
 }
 
-void Board::initNeighbors()
+EvalFeatures Board::computeFeatures() const
 {
-    for (int i = 0; i < NUM_CELLS; ++i) {
-        int m = s_indexToCoord[i].first;
-        int y = s_indexToCoord[i].second;
-
-        for (int d = 0; d < NUM_DIRECTIONS; ++d) {
-            int dm = DIRECTION_OFFSETS[d].first;
-            int dy = DIRECTION_OFFSETS[d].second;
-            int nm = m + dm;
-            int ny = y + dy;
-
-            long long nkey = packCoord(nm, ny);
-            auto it = s_coordToIndex.find(nkey);
-            if (it == s_coordToIndex.end()) {
-                neighbors[i][d] = -1;
-            }
-            else {
-                neighbors[i][d] = it->second;
-            }
+    EvalFeatures f;
+    f.lost = { START_MARBLES, START_MARBLES };
+    for (int i = 0; i < NUM_CELLS; i++) {
+        if (occupant[i] == Occupant::EMPTY)
+            continue;
+        const int c = (occupant[i] == Occupant::WHITE);
+        f.lost[c]--;
+        f.centre[c] += 4 - s_centreDistance[i];
+        f.edge[c] += s_offBoardDirections[i];
+        // E, NW and NE lead to higher indices, so each pair is counted once
+        for (int d : { 1, 2, 3 }) {
+            int next = neighbors[i][d];
+            f.cohesion[c] += (next >= 0 && occupant[next] == occupant[i]);
         }
     }
+    return f;
+}
+
+uint64_t Board::computeHash() const
+{
+    uint64_t key = zobristSide(nextToMove);
+    for (int i = 0; i < NUM_CELLS; ++i)
+        key ^= zobristKey(i, occupant[i]);
+    return key;
 }
 
 int Board::notationToIndex(const std::string& notation)
@@ -718,27 +1059,21 @@ int Board::notationToIndex(const std::string& notation)
     if (notation.size() < 2 || notation.size() > 3) {
         return -1;
     }
-    char letter = std::toupper(notation[0]);
-    int y = (letter - 'A') + 1;
+    int y = (std::toupper(static_cast<unsigned char>(notation[0])) - 'A') + 1;
     if (y < 1 || y > 9) {
         return -1;
     }
 
-    int m = 0;
-    try {
-        m = std::stoi(notation.substr(1));
-    }
-    catch (...) {
+    // Column digits; like std::stoi, anything after the number is ignored ("H9w" -> H9)
+    if (!std::isdigit(static_cast<unsigned char>(notation[1]))) {
         return -1;
     }
-    if (m < 1 || m > 9) {
-        return -1;
+    int m = notation[1] - '0';
+    if (notation.size() == 3 && std::isdigit(static_cast<unsigned char>(notation[2]))) {
+        m = m * 10 + (notation[2] - '0');
     }
-
-    long long key = packCoord(m, y);
-    auto it = s_coordToIndex.find(key);
-    if (it == s_coordToIndex.end()) {
+    if (m < 1 || m > 9) {
         return -1;
     }
-    return it->second;
+    return s_coordToIndex[y][m];
 }
@@ -2,34 +2,179 @@
 #define ABALONE_BOARD_H
 
 #include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iosfwd>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
+#include "HexTopology.h"
+#include "Zobrist.h"
 
-// Simple occupant type: empty, black, white
-enum class Occupant
+
+// Simple occupant type: empty, black, white (one byte, so a Board is ~64 bytes)
+enum class Occupant : uint8_t
 {
     EMPTY = 0,
     BLACK,
     WHITE
 };
 
+// The other colour (for BLACK / WHITE)
+constexpr Occupant opponentOf(Occupant side)
+{
+    return side == Occupant::BLACK ? Occupant::WHITE : Occupant::BLACK;
+}
+
 struct Move {
     // The indices of the marbles being moved. Typically 1–3 contiguous marbles of the same color.
     // For example, {10} for a single marble, or {10,11,12} for three in a line.
     std::vector<int> marbleIndices;
 
     // Which direction (0..5) - matches Board::DIRECTION_OFFSETS
-    int direction;
+    int direction = 0;
 
     // Is it an inline move or sidestep move? (true = inline, false = side-step)
-    bool isInline;
+    bool isInline = true;
 
     // For convenience, store occupant color if you like
     // Occupant who;
 
-    int pushCount;
+    // How many opponent marbles the move pushes (0 for plain moves, 1 or 2 for sumito).
+    int pushCount = 0;
+};
+
+// Fixed-size version of Move for the generator hot path: no heap, 4 bytes.
+// cells[] holds the marble indices in ascending order; unused slots are NO_CELL.
+// info packs the rest: bits 0-2 direction, bit 3 inline, bits 4-5 pushCount, bits 6-7 size.
+struct CompactMove
+{
+    static const uint8_t NO_CELL = 0xFF;
+
+    std::array<uint8_t, 3> cells = { NO_CELL, NO_CELL, NO_CELL };
+    uint8_t info = 0;
+
+    CompactMove() = default;
+
+    // a, b, c are the marble cells in ascending order (NO_CELL for unused slots)
+    CompactMove(int a, int b, int c, int size, int direction, bool isInline, int pushCount)
+        : cells{ { uint8_t(a), uint8_t(b), uint8_t(c) } },
+          info(uint8_t(direction | (isInline ? 8 : 0) | (pushCount << 4) | (size << 6)))
+    {
+    }
+
+    int size() const { return info >> 6; }
+    int direction() const { return info & 7; }
+    bool isInline() const { return (info >> 3) & 1; }
+    int pushCount() const { return (info >> 4) & 3; }
+
+    bool operator==(const CompactMove& o) const { return cells == o.cells && info == o.info; }
+    bool operator!=(const CompactMove& o) const { return !(*this == o); }
+
+    // Conversion to and from the vector-based Move
+    static CompactMove fromMove(const Move& m);
+    Move toMove() const;
+};
+
+// Stack-allocated move container with a fixed capacity.
+// A move is a group plus one of 6 directions, and a group is its lowest marble alone
+// or with one of E, NW, NE (a pair or a triple), so n marbles have at most 6 * 7n
+// moves. PositionReader refuses more than MAX_MARBLES a side, which bounds every list.
+class MoveList
+{
+public:
+    static const int MAX_MARBLES = 14;   // Board::START_MARBLES
+    static const int CAPACITY = 6 * 7 * MAX_MARBLES;
+
+    // Moves past CAPACITY are dropped rather than written out of bounds
+    void push_back(const CompactMove& m)
+    {
+        assert(count < CAPACITY);
+        if (count < CAPACITY)
+            moves[count++] = m;
+    }
+
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    CompactMove& operator[](int i) { return moves[i]; }
+    const CompactMove& operator[](int i) const { return moves[i]; }
+
+    CompactMove* begin() { return moves.data(); }
+    CompactMove* end() { return moves.data() + count; }
+    const CompactMove* begin() const { return moves.data(); }
+    const CompactMove* end() const { return moves.data() + count; }
+
+private:
+    std::array<CompactMove, CAPACITY> moves;
+    int count = 0;
+};
+
+// A position as two 61-bit occupancy masks (bit i = cell i) plus the side to move.
+// Loaders fill these without touching a Board; Board::unpack/pack convert.
+struct PackedPosition
+{
+    uint64_t black = 0;
+    uint64_t white = 0;
+    Occupant toMove = Occupant::BLACK;
+};
+
+// Running per-colour sums the evaluation is built from (index 0 = black, 1 = white).
+// Board keeps them current through setOccupant, applyMove and undoMove the same way
+// it keeps the hash, so a leaf evaluation reads them instead of scanning 61 cells.
+// Evaluation.h turns them into a score.
+struct EvalFeatures
+{
+    std::array<int16_t, 2> lost = { 0, 0 };      // START_MARBLES minus marbles on the board (pushed off)
+    std::array<int16_t, 2> centre = { 0, 0 };    // sum of (4 - distance to E5) over the colour's marbles
+    std::array<int16_t, 2> cohesion = { 0, 0 };  // adjacent pairs of the colour's marbles
+    std::array<int16_t, 2> edge = { 0, 0 };      // sum of off-board directions over the colour's marbles
+
+    bool operator==(const EvalFeatures& o) const
+    {
+        return lost == o.lost && centre == o.centre && cohesion == o.cohesion && edge == o.edge;
+    }
+    bool operator!=(const EvalFeatures& o) const { return !(*this == o); }
+};
+
+// Everything needed to take back a move with Board::undoMove.
+// Cells are stored as they were *before* the move was applied.
+struct MoveUndo
+{
+    CompactMove move;                   // moved cells and direction
+    std::array<uint8_t, 2> pushed = { CompactMove::NO_CELL, CompactMove::NO_CELL }; // nearest first
+    uint8_t pushedCount = 0;
+    uint8_t ejected = CompactMove::NO_CELL; // cell whose marble was pushed off the board, if any
+    Occupant mover = Occupant::EMPTY;
+    Occupant previousToMove = Occupant::BLACK;
+    EvalFeatures previousFeatures;      // restored as a whole by undoMove
+};
+
+// Canonical keys of the moves one generateMoves call has already emitted.
+// A move is fully identified by its sorted cells and direction, and a line of
+// 2 or 3 marbles by its lowest cell and axis, so Board::moveKey is
+//   (lowestCell * 7 + shape) * 6 + direction
+// with shape 0 for a single marble, 1..3 for a pair along E/NW/NE, 4..6 for a triple.
+class MoveKeySet
+{
+public:
+    static const int NUM_KEYS = 61 * 7 * 6;
+
+    // Add 'key'; false if it was already present
+    bool insert(int key)
+    {
+        uint64_t& word = bits[key >> 6];
+        const uint64_t bit = uint64_t(1) << (key & 63);
+        if (word & bit)
+            return false;
+        word |= bit;
+        return true;
+    }
+
+private:
+    std::array<uint64_t, (NUM_KEYS + 63) / 64> bits{};
 };
 
 class Board
@@ -48,30 +193,141 @@ public:
     //  SE= (0,  -1)
     // We'll store them in that order: W=0, E=1, NW=2, NE=3, SW=4, SE=5
     // Each "dxdy" is applied to (m, y).
-    static const std::array<std::pair<int, int>, NUM_DIRECTIONS> DIRECTION_OFFSETS;
+    static constexpr std::array<std::pair<int, int>, NUM_DIRECTIONS> DIRECTION_OFFSETS = { {
+        {-1,  0}, // W
+        {+1,  0}, // E
+        { 0, +1}, // NW
+        {+1, +1}, // NE
+        {-1, -1}, // SW
+        { 0, -1}  // SE
+    } };
+
+    // OPPOSITE_DIRECTION[d] is the direction pointing back along d (W<->E, NW<->SE, NE<->SW).
+    static constexpr std::array<int, NUM_DIRECTIONS> OPPOSITE_DIRECTION = { 1, 0, 5, 4, 3, 2 };
+
+    // ---- Board geometry: computed at compile time (HexTopology.h), shared by every Board ----
+
+    // s_indexToCoord[i] = {m, y} of cell i
+    static constexpr std::array<HexCoord, NUM_CELLS> s_indexToCoord = HexTopology::buildIndexToCoord();
+
+    // s_cellNotation[i] = "C5"-style name of cell i; index order is also lexicographic order
+    static constexpr std::array<std::array<char, 2>, NUM_CELLS> s_cellNotation = HexTopology::buildNotation();
+
+    // s_coordToIndex[y][m] = cell index, or -1 if (m, y) is off the board
+    static constexpr std::array<std::array<int8_t, 10>, 10> s_coordToIndex = HexTopology::buildCoordToIndex();
+
+    // For each cell i, neighbors[i][d] = index of neighbor in direction d, or -1 if none
+    static constexpr std::array<std::array<int8_t, NUM_DIRECTIONS>, NUM_CELLS> neighbors = HexTopology::buildNeighbors();
+
+    // rays[i][d] = every cell from i to the edge in direction d, nearest first
+    static constexpr std::array<std::array<HexTopology::Ray, NUM_DIRECTIONS>, NUM_CELLS> rays = HexTopology::buildRays();
+
+    // Every line of 2 or 3 cells with its push rays and broadside destinations, grouped by lowest cell
+    static constexpr HexTopology::LineTable s_lines = HexTopology::buildLines();
+
+    // s_centreDistance[i] = hex distance from E5 (0..4); s_offBoardDirections[i] = directions leading off the board
+    static constexpr std::array<int8_t, NUM_CELLS> s_centreDistance = HexTopology::buildCentreDistance();
+    static constexpr std::array<int8_t, NUM_CELLS> s_offBoardDirections = HexTopology::buildOffBoardDirections();
+
+    static const int START_MARBLES = 14;   // marbles per side in every standard layout
+
+    // ---- Zobrist hashing ----
+    static constexpr std::array<std::array<uint64_t, 2>, NUM_CELLS> ZOBRIST_CELL = Zobrist::buildCellKeys();
+    static constexpr uint64_t ZOBRIST_WHITE_TO_MOVE = Zobrist::buildSideKey();
+
+    static uint64_t zobristKey(int index, Occupant who)
+    {
+        return who == Occupant::EMPTY ? 0 : ZOBRIST_CELL[index][who == Occupant::WHITE];
+    }
+    static uint64_t zobristSide(Occupant toMove)
+    {
+        return toMove == Occupant::WHITE ? ZOBRIST_WHITE_TO_MOVE : 0;
+    }
 
     Occupant nextToMove = Occupant::BLACK;
 
-    // Generate all legal moves for 'side'
+    // 64-bit position key over cell x colour plus side to move. Kept current by
+    // setOccupant, the layout/loading functions, applyMove and undoMove; code that
+    // writes occupant[] or nextToMove directly must call refreshIncremental() afterwards.
+    uint64_t hash = 0;
+
+    // Evaluation feature sums, maintained alongside the hash (see EvalFeatures)
+    EvalFeatures features;
+
+    // Key and features recomputed from scratch (references for the incremental ones)
+    uint64_t computeHash() const;
+    EvalFeatures computeFeatures() const;
+    void refreshIncremental() { hash = computeHash(); features = computeFeatures(); }
+
+    // Generate all legal moves for 'side', each distinct move exactly once
     std::vector<Move> generateMoves(Occupant side) const;
 
     void generateGroupMoves(const std::vector<int>& group, int d, std::vector<Move>& moves) const;
-
-    // Apply a move to *this* board (modifying occupant[]).
-    // Alternatively, you can return a new Board if you prefer a copy-on-write style.
-    void applyMove(const Move& m);
+    void generateGroupMoves(const std::vector<int>& group, int d, std::vector<Move>& moves, MoveKeySet& seen) const;
+
+    // Allocation-free versions: same move set, written into a caller-owned MoveList
+    void generateMoves(Occupant side, MoveList& moves) const;
+
+    // Staged generation for move ordering: the two calls together give exactly the
+    // generateMoves set. Pushes are the sumito moves (pushCount() > 0) and come only
+    // from own lines, so they are found without building any quiet move.
+    // GEN_CAPTURES narrows pushes to the ones that eject a marble (quiescence search).
+    static const int GEN_PUSHES = 1;
+    static const int GEN_QUIET = 2;
+    static const int GEN_ALL = GEN_PUSHES | GEN_QUIET;
+    static const int GEN_CAPTURES = 4;
+    void generatePushes(Occupant side, MoveList& moves) const;
+    void generateQuietMoves(Occupant side, MoveList& moves) const;
+    void generateCaptures(Occupant side, MoveList& moves) const;
+
+    // True if push m sends a marble off the board (geometry only; m must be legal)
+    static bool ejects(const CompactMove& m);
+
+    // True if m is one of the moves generateMoves(nextToMove) would produce, e.g. to
+    // vet a transposition-table move before playing it without generating everything
+    bool isLegal(const CompactMove& m) const;
+
+    // Side-specialised cores (Side = BLACK or WHITE): every colour test and opponent
+    // lookup is a compile-time constant. generateMoves(side, MoveList&) and
+    // applyMove(CompactMove) dispatch to these; hot loops can call them directly.
+    template <Occupant Side, int Kinds = GEN_ALL> void generateMovesFor(MoveList& moves) const;
+    template <Occupant Side> MoveUndo applyMoveFor(const CompactMove& m);
+
+    // Bit i set where cell i holds a marble of 'side'
+    uint64_t occupancyMask(Occupant side) const;
+
+    // Canonical (sorted cells, direction) key of a move, see MoveKeySet
+    static int moveKey(const CompactMove& m);
+
+    // Moves the generators dropped because an identical move had already been emitted
+    static uint64_t duplicateMovesSuppressed() { return s_duplicateMoves.load(std::memory_order_relaxed); }
+
+    // Apply a move to *this* board (modifying occupant[]) and hand the turn to the other side.
+    // The returned record lets undoMove restore the exact previous position,
+    // so a search can walk the tree on one board instead of copying it per child.
+    MoveUndo applyMove(const Move& m);
+    MoveUndo applyMove(const CompactMove& m);
+
+    // Take back the move described by 'undo' (must be the most recent one applied)
+    void undoMove(const MoveUndo& undo);
 
     // Make a notation string like "(b, 2m) i → NW" given a Move & occupant color
     static std::string moveToNotation(const Move& m, Occupant side);
+    static std::string moveToNotation(const CompactMove& m, Occupant side);
 
     // Convert board occupant array to e.g. "C5b,D5b,E4b,..." sorted black first, then white
     std::string toBoardString() const;
 
+    // Same text appended to a caller-owned buffer: no sorting, and no allocation once
+    // the buffer has grown (reuse it with clear() between calls)
+    static void appendMoveNotation(std::string& out, const CompactMove& m, Occupant side);
+    void appendBoardString(std::string& out) const;
+
 
     static std::string indexToNotation(int idx);
 
 
-    // Hardcode these:
+    // The three tournament starting positions, black to move:
     void initStandardLayout();
     void initBelgianDaisyLayout();
     void initGermanDaisyLayout();
@@ -79,14 +335,22 @@ public:
     // Load from your 2-line input file
     bool loadFromInputFile(const std::string& filename);
 
+    // Same two-line format read from any stream (the next two lines of 'in')
+    bool loadFromStream(std::istream& in);
+
+    // Whole-position conversion to / from the packed mask form
+    PackedPosition pack() const;
+    void unpack(const PackedPosition& pos);
+
+    // Packed position after move m, computed from 'current' (this board, packed) and
+    // the move's cell deltas without applying it. m must be a legal move here.
+    PackedPosition packAfter(const PackedPosition& current, const CompactMove& m) const;
+
     void setOccupant(const std::string& notation, Occupant who);
 
     // Board storage: occupant[i] says who is in cell index i
     std::array<Occupant, NUM_CELLS> occupant;
 
-    // For each cell i, neighbors[i][d] = index of neighbor in direction d, or -1 if none
-    std::array<std::array<int, NUM_DIRECTIONS>, NUM_CELLS> neighbors;
-
     // Constructor
     Board();
 
@@ -99,7 +363,11 @@ public:
     {
         if (index >= 0 && index < NUM_CELLS)
         {
-            occupant[index] = who;
+            hash ^= zobristKey(index, occupant[index]) ^ zobristKey(index, who);
+            if (occupant[index] != Occupant::EMPTY)
+                liftMarble(index);
+            if (who != Occupant::EMPTY)
+                placeMarble(index, who);
         }
     }
 
@@ -112,20 +380,60 @@ public:
     }
 
 private:
-    // Once we have a (m,y) → index table, we can use it to build neighbors[][]
-    static void initMapping();
-    static bool s_mappingInitialized;
+    // Build the undo record for 'm' from the current (pre-move) position
+    MoveUndo makeUndo(const CompactMove& m) const;
+    template <Occupant Side> MoveUndo makeUndoFor(const CompactMove& m) const;
+
+    // XOR the key changes of the move in 'undo' into hash; applying it twice cancels out
+    void toggleMoveHash(const MoveUndo& undo);
+
+    // Debug builds: the incremental key and features must match a full recompute
+    void checkHash() const { assert(hash == computeHash() && "incremental Zobrist key drifted"); }
+    void checkFeatures() const { assert(features == computeFeatures() && "incremental evaluation features drifted"); }
+
+    // Put a marble on / take one off an occupied cell, updating features (not the hash).
+    // Cohesion counts same-colour neighbours at the time of the call, so a move is
+    // replayed as a sequence of these and every step sees a real position.
+    int sameColourNeighbours(int cell, Occupant who) const
+    {
+        int count = 0;
+        for (int d = 0; d < NUM_DIRECTIONS; d++) {
+            int next = neighbors[cell][d];
+            count += (next >= 0 && occupant[next] == who);
+        }
+        return count;
+    }
+    void placeMarble(int cell, Occupant who)
+    {
+        const int c = (who == Occupant::WHITE);
+        occupant[cell] = who;
+        features.lost[c]--;
+        features.centre[c] += 4 - s_centreDistance[cell];
+        features.edge[c] += s_offBoardDirections[cell];
+        features.cohesion[c] += sameColourNeighbours(cell, who);
+    }
+    void liftMarble(int cell)
+    {
+        const Occupant who = occupant[cell];
+        const int c = (who == Occupant::WHITE);
+        occupant[cell] = Occupant::EMPTY;
+        features.lost[c]++;
+        features.centre[c] -= 4 - s_centreDistance[cell];
+        features.edge[c] -= s_offBoardDirections[cell];
+        features.cohesion[c] -= sameColourNeighbours(cell, who);
+    }
 
-    // For every valid (m,y), we store its index in s_coordToIndex
-    // e.g. s_coordToIndex[{1,1}] = 0, s_coordToIndex[{1,2}] = 1, ...
-    // or you can store a single key like (m << 8) + y
-    static std::unordered_map<long long, int> s_coordToIndex;
+    // Inline and side-step moves for one table line fully occupied by our marbles
+    // (Kinds selects pushes, quiet moves or both, or only the ejecting pushes)
+    template <int Kinds = GEN_ALL>
+    static void generateLineMoves(const HexTopology::Line& line, uint64_t own, uint64_t opp,
+        MoveList& moves, MoveKeySet& seen);
 
-    // For reverse mapping: s_indexToCoord[i] = {m,y}
-    static std::array<std::pair<int, int>, NUM_CELLS> s_indexToCoord;
+    // Append m unless its key is already in 'seen' (then count it as a duplicate)
+    static void pushUnique(std::vector<Move>& moves, const Move& m, MoveKeySet& seen);
+    static void pushUnique(MoveList& moves, const CompactMove& m, MoveKeySet& seen);
 
-    // Build the neighbor array
-    void initNeighbors();
+    static std::atomic<uint64_t> s_duplicateMoves;
 };
 
 #endif // ABALONE_BOARD_H
@@ -0,0 +1,235 @@
+#include "ChildEval.h"
+#include "Evaluation.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ABALONE_CHILDEVAL_AVX2 1
+#include <immintrin.h>
+#endif
+
+//========================== 0) Cell sets ==========================//
+
+// Shifts s such that some cell's E, NW or NE neighbour is s indices further on:
+// E is always +1; NW / NE step over the rest of the row, 5..9 cells depending on the row.
+static constexpr int NUM_SHIFTS = 6;
+static constexpr int SHIFTS[NUM_SHIFTS] = { 1, 5, 6, 7, 8, 9 };
+
+struct FeatureMasks
+{
+    uint64_t within[4];             // cells at most k rings from E5, k = 0..3
+    uint64_t rim;                   // distance 4 (two off-board directions or more)
+    uint64_t corners;               // three off-board directions
+    uint64_t pairs[NUM_SHIFTS];     // cells whose forward neighbour is SHIFTS[j] further on
+};
+
+static constexpr FeatureMasks buildFeatureMasks()
+{
+    FeatureMasks masks{};
+    for (int i = 0; i < Board::NUM_CELLS; i++) {
+        const uint64_t bit = uint64_t(1) << i;
+        for (int k = 0; k < 4; k++)
+            if (Board::s_centreDistance[i] <= k)
+                masks.within[k] |= bit;
+        if (Board::s_centreDistance[i] == 4)
+            masks.rim |= bit;
+        if (Board::s_offBoardDirections[i] == 3)
+            masks.corners |= bit;
+        for (int d : { 1, 2, 3 }) {   // E, NW, NE
+            const int next = Board::neighbors[i][d];
+            for (int j = 0; j < NUM_SHIFTS; j++)
+                if (next >= 0 && next - i == SHIFTS[j])
+                    masks.pairs[j] |= bit;
+        }
+    }
+    return masks;
+}
+
+static constexpr FeatureMasks MASKS = buildFeatureMasks();
+
+// Every forward neighbour relation must land in exactly one pairs[] set
+static constexpr bool pairsCoverAllNeighbours()
+{
+    int relations = 0, covered = 0;
+    for (int i = 0; i < Board::NUM_CELLS; i++)
+        for (int d : { 1, 2, 3 })
+            relations += (Board::neighbors[i][d] >= 0);
+    for (int j = 0; j < NUM_SHIFTS; j++)
+        for (int i = 0; i < Board::NUM_CELLS; i++)
+            covered += int((MASKS.pairs[j] >> i) & 1);
+    return relations == covered;
+}
+static_assert(pairsCoverAllNeighbours(), "a neighbour step is missing from SHIFTS");
+// The edge term relies on every rim cell having 2 off-board directions, corners 3, inner cells 0
+static constexpr bool edgeMatchesRimAndCorners()
+{
+    for (int i = 0; i < Board::NUM_CELLS; i++)
+        if (Board::s_offBoardDirections[i] != 2 * int((MASKS.rim >> i) & 1) + int((MASKS.corners >> i) & 1))
+            return false;
+    return true;
+}
+static_assert(edgeMatchesRimAndCorners(), "edge = 2 per rim marble + 1 per corner marble");
+
+//========================== 1) Batch construction ==========================//
+
+void ChildBatch::fromMoves(const Board& parent, const MoveList& moves, int first) {
+    const PackedPosition current = parent.pack();
+    clear(opponentOf(parent.nextToMove));
+    for (int i = first; i < moves.size(); i++) {
+        const PackedPosition child = parent.packAfter(current, moves[i]);
+        add(child.black, child.white);
+    }
+}
+
+//========================== 2) Scalar kernel ==========================//
+
+// The colour-independent half of Evaluation::score for one colour's mask
+// (score = side to move's value - opponent's value; lost = START_MARBLES - marbles).
+static inline int64_t maskValue(uint64_t m) {
+    const int64_t marbles = __builtin_popcountll(m);
+    int64_t centre = 0;
+    for (int k = 0; k < 4; k++)
+        centre += __builtin_popcountll(m & MASKS.within[k]);
+    const int64_t edge = 2 * __builtin_popcountll(m & MASKS.rim) + __builtin_popcountll(m & MASKS.corners);
+    int64_t cohesion = 0;
+    for (int j = 0; j < NUM_SHIFTS; j++)
+        cohesion += __builtin_popcountll(m & (m >> SHIFTS[j]) & MASKS.pairs[j]);
+    return Evaluation::MARBLE_VALUE * marbles + Evaluation::CENTRE_VALUE * centre
+        + Evaluation::COHESION_VALUE * cohesion - Evaluation::EDGE_VALUE * edge;
+}
+
+static void scalarRange(const ChildBatch& batch, int first, int* scores) {
+    const bool whiteToMove = (batch.toMove == Occupant::WHITE);
+    for (int i = first; i < batch.count; i++) {
+        const int64_t b = maskValue(batch.black[i]);
+        const int64_t w = maskValue(batch.white[i]);
+        scores[i] = int(whiteToMove ? w - b : b - w);
+    }
+}
+
+#ifdef ABALONE_CHILDEVAL_AVX2
+// The same loop compiled with the POPCNT instruction; without it the builtin is a library call
+__attribute__((target("popcnt"))) static void popcntRange(const ChildBatch& batch, int first, int* scores) {
+    const bool whiteToMove = (batch.toMove == Occupant::WHITE);
+    for (int i = first; i < batch.count; i++) {
+        const int64_t b = maskValue(batch.black[i]);
+        const int64_t w = maskValue(batch.white[i]);
+        scores[i] = int(whiteToMove ? w - b : b - w);
+    }
+}
+
+static bool popcntAvailable() {
+    static const bool available = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("popcnt") != 0;
+    }();
+    return available;
+}
+#endif
+
+void ChildEval::evaluateScalar(const ChildBatch& batch, int* scores) {
+#ifdef ABALONE_CHILDEVAL_AVX2
+    if (popcntAvailable()) {
+        popcntRange(batch, 0, scores);
+        return;
+    }
+#endif
+    scalarRange(batch, 0, scores);
+}
+
+//========================== 3) AVX2 kernel ==========================//
+
+#ifdef ABALONE_CHILDEVAL_AVX2
+
+#define ABALONE_AVX2 __attribute__((target("avx2")))
+
+// Per-byte popcount (nibble lookup), then horizontal byte sums per 64-bit lane.
+// Byte counts of several terms are added before summing; each is at most 8 per
+// byte, and no feature adds more than 6 terms, so bytes never overflow.
+ABALONE_AVX2 static inline __m256i popcountBytes(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i lo = _mm256_and_si256(v, nibble);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+}
+
+ABALONE_AVX2 static inline __m256i sumBytes(__m256i counts) {
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+ABALONE_AVX2 static inline __m256i maskedCount(__m256i m, uint64_t cells) {
+    return popcountBytes(_mm256_and_si256(m, _mm256_set1_epi64x(int64_t(cells))));
+}
+
+// Four masks at once; same formula as maskValue
+ABALONE_AVX2 static inline __m256i maskValues(__m256i m) {
+    const __m256i marbles = sumBytes(popcountBytes(m));
+
+    __m256i centre = maskedCount(m, MASKS.within[0]);
+    for (int k = 1; k < 4; k++)
+        centre = _mm256_add_epi8(centre, maskedCount(m, MASKS.within[k]));
+
+    const __m256i rim = maskedCount(m, MASKS.rim);
+    const __m256i edge = _mm256_add_epi8(_mm256_add_epi8(rim, rim), maskedCount(m, MASKS.corners));
+
+    __m256i cohesion = _mm256_setzero_si256();
+    const __m128i shifts[NUM_SHIFTS] = { _mm_cvtsi32_si128(1), _mm_cvtsi32_si128(5), _mm_cvtsi32_si128(6),
+        _mm_cvtsi32_si128(7), _mm_cvtsi32_si128(8), _mm_cvtsi32_si128(9) };
+    for (int j = 0; j < NUM_SHIFTS; j++)
+        cohesion = _mm256_add_epi8(cohesion, maskedCount(_mm256_and_si256(m, _mm256_srl_epi64(m, shifts[j])), MASKS.pairs[j]));
+
+    // Counts are small and non-negative, so a 32x32 -> 64 unsigned multiply is exact
+    __m256i value = _mm256_mul_epu32(marbles, _mm256_set1_epi64x(Evaluation::MARBLE_VALUE));
+    value = _mm256_add_epi64(value, _mm256_mul_epu32(sumBytes(centre), _mm256_set1_epi64x(Evaluation::CENTRE_VALUE)));
+    value = _mm256_add_epi64(value, _mm256_mul_epu32(sumBytes(cohesion), _mm256_set1_epi64x(Evaluation::COHESION_VALUE)));
+    value = _mm256_sub_epi64(value, _mm256_mul_epu32(sumBytes(edge), _mm256_set1_epi64x(Evaluation::EDGE_VALUE)));
+    return value;
+}
+
+ABALONE_AVX2 static int avx2Range(const ChildBatch& batch, int* scores) {
+    const bool whiteToMove = (batch.toMove == Occupant::WHITE);
+    alignas(32) int64_t lanes[4];
+    int i = 0;
+    for (; i + 4 <= batch.count; i += 4) {
+        const __m256i b = maskValues(_mm256_load_si256(reinterpret_cast<const __m256i*>(batch.black + i)));
+        const __m256i w = maskValues(_mm256_load_si256(reinterpret_cast<const __m256i*>(batch.white + i)));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), whiteToMove ? _mm256_sub_epi64(w, b) : _mm256_sub_epi64(b, w));
+        for (int k = 0; k < 4; k++)
+            scores[i + k] = int(lanes[k]);
+    }
+    return i;   // first child left for the scalar tail
+}
+
+#endif
+
+//========================== 4) Dispatch ==========================//
+
+bool ChildEval::simdAvailable() {
+#ifdef ABALONE_CHILDEVAL_AVX2
+    static const bool available = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+void ChildEval::evaluateSimd(const ChildBatch& batch, int* scores) {
+#ifdef ABALONE_CHILDEVAL_AVX2
+    if (simdAvailable()) {
+        const int tail = avx2Range(batch, scores);
+        if (popcntAvailable())
+            popcntRange(batch, tail, scores);
+        else
+            scalarRange(batch, tail, scores);
+        return;
+    }
+#endif
+    evaluateScalar(batch, scores);
+}
+
+void ChildEval::evaluate(const ChildBatch& batch, int* scores) {
+    evaluateSimd(batch, scores);
+}
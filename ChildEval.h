@@ -0,0 +1,46 @@
+#ifndef ABALONE_CHILDEVAL_H
+#define ABALONE_CHILDEVAL_H
+
+#include "Board.h"
+#include <cstdint>
+
+// Children of one position as packed masks, structure-of-arrays so a kernel can
+// load four children's black masks (then white masks) in one vector each.
+// Every child has the same side to move: the opponent of the parent's mover.
+struct ChildBatch
+{
+    static const int CAPACITY = MoveList::CAPACITY;
+
+    alignas(32) uint64_t black[CAPACITY];
+    alignas(32) uint64_t white[CAPACITY];
+    int count = 0;
+    Occupant toMove = Occupant::BLACK;
+
+    void clear(Occupant side) { count = 0; toMove = side; }
+    void add(uint64_t b, uint64_t w) { black[count] = b; white[count] = w; count++; }
+
+    // One child per move of 'parent' from moves[first] on, built from the parent's masks
+    // plus each move's cell deltas (Board::packAfter) - the parent board is not modified.
+    void fromMoves(const Board& parent, const MoveList& moves, int first = 0);
+};
+
+// Batched static evaluation: scores[i] = Evaluation::score for child i, from the
+// point of view of batch.toMove. Works on the masks only; every feature is a sum of
+// popcounts of the masks ANDed with fixed cell sets:
+//   centre   = sum over k = 0..3 of |m & within k rings of E5|   (4 - distance per marble)
+//   edge     = 2 * |m & rim| + |m & corners|                     (off-board directions)
+//   cohesion = sum over shifts s of |m & (m >> s) & pairs(s)|    (adjacent pairs)
+// where pairs(s) holds the cells whose E, NW or NE neighbour is s indices further on.
+// The AVX2 kernel (picked at run time when the CPU has it) and the scalar kernel
+// use integer arithmetic only, so their results are bit-identical.
+struct ChildEval
+{
+    static void evaluate(const ChildBatch& batch, int* scores);
+
+    static void evaluateScalar(const ChildBatch& batch, int* scores);
+    static void evaluateSimd(const ChildBatch& batch, int* scores);   // scalar if no AVX2
+
+    static bool simdAvailable();
+};
+
+#endif // ABALONE_CHILDEVAL_H
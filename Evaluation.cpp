@@ -0,0 +1,9 @@
+#include "Evaluation.h"
+
+int Evaluation::evaluateFromScratch(const Board& board) {
+    return score(board.computeFeatures(), board.nextToMove);
+}
+
+bool Evaluation::consistent(const Board& board) {
+    return board.features == board.computeFeatures() && evaluate(board) == evaluateFromScratch(board);
+}
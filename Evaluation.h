@@ -0,0 +1,41 @@
+#ifndef ABALONE_EVALUATION_H
+#define ABALONE_EVALUATION_H
+
+#include "Board.h"
+
+// Static evaluation built from the feature sums a Board keeps current (EvalFeatures).
+//
+// The score is from the side to move's point of view, each term as (ours - theirs):
+//   material  MARBLE_VALUE   per marble lost, counted against the loser
+//   centre    CENTRE_VALUE   per ring closer to E5, summed over marbles
+//   cohesion  COHESION_VALUE per pair of adjacent own marbles
+//   edge      EDGE_VALUE     per direction an own marble could be pushed straight off, as a penalty
+//
+// evaluate() only reads board.features, so a leaf costs a handful of adds;
+// evaluateFromScratch() rescans the board and is the reference it must agree with.
+struct Evaluation
+{
+    static constexpr int MARBLE_VALUE = 100;
+    static constexpr int CENTRE_VALUE = 2;
+    static constexpr int COHESION_VALUE = 3;
+    static constexpr int EDGE_VALUE = 4;
+
+    static int score(const EvalFeatures& f, Occupant us)
+    {
+        const int u = (us == Occupant::WHITE);
+        const int t = 1 - u;
+        return MARBLE_VALUE * (f.lost[t] - f.lost[u])
+            + CENTRE_VALUE * (f.centre[u] - f.centre[t])
+            + COHESION_VALUE * (f.cohesion[u] - f.cohesion[t])
+            - EDGE_VALUE * (f.edge[u] - f.edge[t]);
+    }
+
+    static int evaluate(const Board& board) { return score(board.features, board.nextToMove); }
+
+    static int evaluateFromScratch(const Board& board);
+
+    // True if the incremental features (and so the score) match a full rescan
+    static bool consistent(const Board& board);
+};
+
+#endif // ABALONE_EVALUATION_H
@@ -0,0 +1,347 @@
+#ifndef ABALONE_HEXTOPOLOGY_H
+#define ABALONE_HEXTOPOLOGY_H
+
+#include <array>
+#include <cstdint>
+
+// Compile-time geometry of the 61-cell board.
+//
+// Cells are numbered row by row: row y = 1..9 (letters A..I) holds columns
+// m = max(1, y-4) .. min(9, y+4), so A1 = 0, A5 = 4, B1 = 5, ... I9 = 60.
+// Every table here is built by constexpr functions and shared by all Boards.
+
+struct HexCoord
+{
+    int m; // column, 1..9
+    int y; // row, 1..9 (A..I)
+};
+
+struct HexTopology
+{
+    static constexpr int NUM_CELLS = 61;
+    static constexpr int NUM_DIRECTIONS = 6;
+    static constexpr int MAX_RAY = 8;    // longest straight run leaving a cell (edge to edge)
+
+    // (dm, dy) per direction, ordered W, E, NW, NE, SW, SE (see Board::DIRECTION_OFFSETS)
+    static constexpr int DM[NUM_DIRECTIONS] = { -1, +1, 0, +1, -1, 0 };
+    static constexpr int DY[NUM_DIRECTIONS] = { 0, 0, +1, +1, -1, -1 };
+
+    static constexpr int rowFirstColumn(int y) { return y - 4 > 1 ? y - 4 : 1; }
+    static constexpr int rowLastColumn(int y) { return y + 4 < 9 ? y + 4 : 9; }
+
+    static constexpr bool isValid(int m, int y)
+    {
+        return y >= 1 && y <= 9 && m >= rowFirstColumn(y) && m <= rowLastColumn(y);
+    }
+
+    static constexpr std::array<HexCoord, NUM_CELLS> buildIndexToCoord()
+    {
+        std::array<HexCoord, NUM_CELLS> table{};
+        int idx = 0;
+        for (int y = 1; y <= 9; ++y)
+            for (int m = rowFirstColumn(y); m <= rowLastColumn(y); ++m)
+                table[idx++] = HexCoord{ m, y };
+        return table;
+    }
+
+    // Board notation per cell: row letter then column digit, e.g. "C5" (always two characters)
+    static constexpr std::array<std::array<char, 2>, NUM_CELLS> buildNotation()
+    {
+        std::array<std::array<char, 2>, NUM_CELLS> table{};
+        const auto coords = buildIndexToCoord();
+        for (int i = 0; i < NUM_CELLS; ++i)
+            table[i] = { char('A' + coords[i].y - 1), char('0' + coords[i].m) };
+        return table;
+    }
+
+    // True if cell index order is also the lexicographic order of the notation,
+    // which lets output code write cells in index order without sorting.
+    static constexpr bool indexOrderIsLexicographic()
+    {
+        const auto names = buildNotation();
+        for (int i = 1; i < NUM_CELLS; ++i)
+            if (names[i - 1][0] > names[i][0] || (names[i - 1][0] == names[i][0] && names[i - 1][1] >= names[i][1]))
+                return false;
+        return true;
+    }
+
+    // [y][m] -> cell index, -1 where (m, y) is not on the board. Row/column 0 are unused.
+    static constexpr std::array<std::array<int8_t, 10>, 10> buildCoordToIndex()
+    {
+        std::array<std::array<int8_t, 10>, 10> table{};
+        for (auto& row : table)
+            for (auto& cell : row)
+                cell = -1;
+        int idx = 0;
+        for (int y = 1; y <= 9; ++y)
+            for (int m = rowFirstColumn(y); m <= rowLastColumn(y); ++m)
+                table[y][m] = int8_t(idx++);
+        return table;
+    }
+
+    // neighbors[i][d] = index of the neighbor in direction d, or -1 off the board
+    static constexpr std::array<std::array<int8_t, NUM_DIRECTIONS>, NUM_CELLS> buildNeighbors()
+    {
+        std::array<std::array<int8_t, NUM_DIRECTIONS>, NUM_CELLS> table{};
+        const auto coords = buildIndexToCoord();
+        const auto index = buildCoordToIndex();
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+                int nm = coords[i].m + DM[d];
+                int ny = coords[i].y + DY[d];
+                table[i][d] = isValid(nm, ny) ? index[ny][nm] : int8_t(-1);
+            }
+        }
+        return table;
+    }
+
+    // Hex distance from the centre cell E5: 0 at the centre, 4 on the rim
+    static constexpr std::array<int8_t, NUM_CELLS> buildCentreDistance()
+    {
+        std::array<int8_t, NUM_CELLS> table{};
+        const auto coords = buildIndexToCoord();
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            int dm = coords[i].m - 5;
+            int dy = coords[i].y - 5;
+            int a = dm < 0 ? -dm : dm;
+            int b = dy < 0 ? -dy : dy;
+            int c = dm - dy < 0 ? dy - dm : dm - dy;
+            table[i] = int8_t(a > b ? (a > c ? a : c) : (b > c ? b : c));
+        }
+        return table;
+    }
+
+    // Directions that lead straight off the board: 0 inside, 2 along a rim, 3 in a corner
+    static constexpr std::array<int8_t, NUM_CELLS> buildOffBoardDirections()
+    {
+        std::array<int8_t, NUM_CELLS> table{};
+        const auto next = buildNeighbors();
+        for (int i = 0; i < NUM_CELLS; ++i)
+            for (int d = 0; d < NUM_DIRECTIONS; ++d)
+                table[i] += int8_t(next[i][d] < 0);
+        return table;
+    }
+
+    // Cells met walking from i in direction d, nearest first, padded with -1
+    struct Ray
+    {
+        std::array<int8_t, MAX_RAY> cells;
+        int8_t length;
+    };
+
+    static constexpr std::array<std::array<Ray, NUM_DIRECTIONS>, NUM_CELLS> buildRays()
+    {
+        std::array<std::array<Ray, NUM_DIRECTIONS>, NUM_CELLS> table{};
+        const auto next = buildNeighbors();
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+                Ray& ray = table[i][d];
+                for (auto& c : ray.cells)
+                    c = -1;
+                ray.length = 0;
+                for (int cur = next[i][d]; cur >= 0; cur = next[cur][d])
+                    ray.cells[ray.length++] = int8_t(cur);
+            }
+        }
+        return table;
+    }
+
+    // ---- Symmetries ----
+
+    // The hexagon has 12 symmetries: 6 rotations about E5, each with or without a
+    // reflection. In offsets (q, r) = (m - 5, y - 5) from the centre a rotation by
+    // 60 degrees is (q, r) -> (q - r, q), taking E to NE, NE to NW and so on, and the
+    // reflection swaps q and r (E <-> NW, NE and SW stay). Symmetry s = 2k + f means
+    // reflect if f, then rotate k times; s = 0 is the identity.
+    static constexpr int NUM_SYMMETRIES = 12;
+
+    static constexpr void applySymmetry(int s, int& q, int& r)
+    {
+        if (s & 1) {
+            int t = q; q = r; r = t;
+        }
+        for (int k = 0; k < s / 2; ++k) {
+            int t = q; q = q - r; r = t;
+        }
+    }
+
+    // [s][i] = the cell that cell i lands on under symmetry s
+    static constexpr std::array<std::array<int8_t, NUM_CELLS>, NUM_SYMMETRIES> buildSymmetryCells()
+    {
+        std::array<std::array<int8_t, NUM_CELLS>, NUM_SYMMETRIES> table{};
+        const auto coords = buildIndexToCoord();
+        const auto index = buildCoordToIndex();
+        for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+            for (int i = 0; i < NUM_CELLS; ++i) {
+                int q = coords[i].m - 5, r = coords[i].y - 5;
+                applySymmetry(s, q, r);
+                table[s][i] = isValid(q + 5, r + 5) ? index[r + 5][q + 5] : int8_t(-1);
+            }
+        }
+        return table;
+    }
+
+    // [s][d] = the direction that d turns into under symmetry s
+    static constexpr std::array<std::array<int8_t, NUM_DIRECTIONS>, NUM_SYMMETRIES> buildSymmetryDirections()
+    {
+        std::array<std::array<int8_t, NUM_DIRECTIONS>, NUM_SYMMETRIES> table{};
+        for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+            for (int d = 0; d < NUM_DIRECTIONS; ++d) {
+                int q = DM[d], r = DY[d];
+                applySymmetry(s, q, r);
+                table[s][d] = -1;
+                for (int e = 0; e < NUM_DIRECTIONS; ++e)
+                    if (DM[e] == q && DY[e] == r)
+                        table[s][d] = int8_t(e);
+            }
+        }
+        return table;
+    }
+
+    // [s] = the symmetry that undoes s
+    static constexpr std::array<int8_t, NUM_SYMMETRIES> buildInverseSymmetries()
+    {
+        std::array<int8_t, NUM_SYMMETRIES> table{};
+        const auto cells = buildSymmetryCells();
+        for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+            table[s] = -1;
+            for (int t = 0; t < NUM_SYMMETRIES && table[s] < 0; ++t) {
+                bool undoes = true;
+                for (int i = 0; i < NUM_CELLS; ++i)
+                    undoes = undoes && cells[t][cells[s][i]] == i;
+                if (undoes)
+                    table[s] = int8_t(t);
+            }
+        }
+        return table;
+    }
+
+    // Every symmetry must permute the cells and the directions, and have an inverse
+    static constexpr bool symmetriesArePermutations()
+    {
+        const auto cells = buildSymmetryCells();
+        const auto dirs = buildSymmetryDirections();
+        const auto inverse = buildInverseSymmetries();
+        for (int s = 0; s < NUM_SYMMETRIES; ++s) {
+            uint64_t hit = 0;
+            for (int i = 0; i < NUM_CELLS; ++i)
+                if (cells[s][i] >= 0)
+                    hit |= uint64_t(1) << cells[s][i];
+            int dirHit = 0;
+            for (int d = 0; d < NUM_DIRECTIONS; ++d)
+                if (dirs[s][d] >= 0)
+                    dirHit |= 1 << dirs[s][d];
+            if (hit != (uint64_t(1) << NUM_CELLS) - 1 || dirHit != (1 << NUM_DIRECTIONS) - 1 || inverse[s] < 0)
+                return false;
+        }
+        return true;
+    }
+
+    // ---- Lines of 2 and 3 marbles ----
+
+    // One geometric line of 2 or 3 adjacent cells along E, NW or NE, listed from
+    // its lowest cell. Holds everything move generation needs beyond occupancy.
+    struct Line
+    {
+        std::array<int8_t, 3> cells;                  // ascending, -1 past 'size'
+        int8_t size;
+        int8_t axis;                                  // 1 = E, 2 = NW, 3 = NE
+        uint64_t mask;                                // bit per cell of the line
+        // ahead[0]: cells beyond the front going along axis; ahead[1]: beyond the back
+        // going the opposite way. Nearest first, -1 past the edge. Enough for a
+        // destination, up to two pushed marbles and the cell they land on.
+        std::array<std::array<int8_t, 3>, 2> ahead;
+        uint8_t sideValid;                            // bit sd: every cell has a neighbour in sd
+        std::array<uint64_t, NUM_DIRECTIONS> sideMask; // broadside destinations for each sd
+    };
+
+    static constexpr int countLines()
+    {
+        const auto next = buildNeighbors();
+        int count = 0;
+        for (int i = 0; i < NUM_CELLS; ++i)
+            for (int axis = 1; axis <= 3; ++axis)
+                if (next[i][axis] >= 0)
+                    count += (next[next[i][axis]][axis] >= 0) ? 2 : 1;
+        return count;
+    }
+
+    // 3 axes x (52 pairs + 43 triples); checked against countLines() below
+    static constexpr int NUM_LINES = 285;
+
+    // Same as Board::OPPOSITE_DIRECTION: W<->E, NW<->SE, NE<->SW
+    static constexpr int oppositeOf(int d) { return d < 2 ? 1 - d : 7 - d; }
+
+    struct LineTable
+    {
+        std::array<Line, NUM_LINES> lines;
+        // Lines whose lowest cell is i are lines[firstLine[i] .. firstLine[i + 1]),
+        // ordered E pair, E triple, NW pair, NW triple, NE pair, NE triple.
+        std::array<uint16_t, NUM_CELLS + 1> firstLine;
+    };
+
+    static constexpr LineTable buildLines()
+    {
+        LineTable table{};
+        const auto next = buildNeighbors();
+        int n = 0;
+        for (int i = 0; i < NUM_CELLS; ++i) {
+            table.firstLine[i] = uint16_t(n);
+            for (int axis = 1; axis <= 3; ++axis) {
+                int cells[3] = { i, next[i][axis], -1 };
+                if (cells[1] < 0)
+                    continue;
+                cells[2] = next[cells[1]][axis];
+                for (int size = 2; size <= 3 && cells[size - 1] >= 0; ++size) {
+                    Line& line = table.lines[n++];
+                    line.size = int8_t(size);
+                    line.axis = int8_t(axis);
+                    line.mask = 0;
+                    for (int k = 0; k < 3; ++k) {
+                        line.cells[k] = int8_t(k < size ? cells[k] : -1);
+                        if (k < size)
+                            line.mask |= uint64_t(1) << cells[k];
+                    }
+
+                    const int ends[2] = { cells[size - 1], cells[0] };
+                    const int dirs[2] = { axis, oppositeOf(axis) };
+                    for (int e = 0; e < 2; ++e) {
+                        int cur = ends[e];
+                        for (int k = 0; k < 3; ++k) {
+                            cur = (cur >= 0) ? next[cur][dirs[e]] : -1;
+                            line.ahead[e][k] = int8_t(cur);
+                        }
+                    }
+
+                    line.sideValid = 0;
+                    for (int sd = 0; sd < NUM_DIRECTIONS; ++sd) {
+                        line.sideMask[sd] = 0;
+                        if (sd == axis || sd == oppositeOf(axis))
+                            continue;
+                        bool valid = true;
+                        for (int k = 0; k < size; ++k) {
+                            int dest = next[cells[k]][sd];
+                            if (dest < 0)
+                                valid = false;
+                            else
+                                line.sideMask[sd] |= uint64_t(1) << dest;
+                        }
+                        if (valid)
+                            line.sideValid |= uint8_t(1 << sd);
+                    }
+                }
+            }
+        }
+        table.firstLine[NUM_CELLS] = uint16_t(n);
+        return table;
+    }
+};
+
+static_assert(HexTopology::buildIndexToCoord()[HexTopology::NUM_CELLS - 1].m == 9
+    && HexTopology::buildIndexToCoord()[HexTopology::NUM_CELLS - 1].y == 9,
+    "cell numbering must end at I9");
+static_assert(HexTopology::countLines() == HexTopology::NUM_LINES, "line table size");
+static_assert(HexTopology::indexOrderIsLexicographic(), "cell notation must sort in index order");
+static_assert(HexTopology::symmetriesArePermutations(), "every board symmetry must permute cells and directions");
+
+#endif // ABALONE_HEXTOPOLOGY_H
@@ -0,0 +1,126 @@
+#include "MovePicker.h"
+#include <algorithm>
+
+//========================== 0) Killers and history ==========================//
+
+void MoveOrdering::clear() {
+    for (auto& slots : killers)
+        slots[0] = slots[1] = CompactMove();
+    for (auto& side : history)
+        std::fill(std::begin(side), std::end(side), 0);
+}
+
+void MoveOrdering::recordCutoff(const CompactMove& m, Occupant side, int ply, int depth) {
+    if (ply <= MAX_PLY && killers[ply][0] != m) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = m;
+    }
+    int& credit = history[side == Occupant::WHITE][Board::moveKey(m)];
+    credit += depth * depth;
+    // Halve the whole table before any entry can overflow; only the ranking matters
+    if (credit > (1 << 28))
+        for (auto& s : history)
+            for (int& h : s)
+                h /= 2;
+}
+
+//========================== 1) Staged picking ==========================//
+
+MovePicker::MovePicker(const Board& board, const CompactMove& ttMove, const MoveOrdering& ordering, int ply)
+    : board(board), ordering(ordering), ply(ply), side(board.nextToMove), ttMove(ttMove) {
+}
+
+CompactMove MovePicker::take(int i) {
+    const CompactMove m = moves[i];
+    moves[i] = moves[cursor];
+    // Only the quiet moves have history scores (filled in by GENERATE_QUIET)
+    if (stage == KILLERS || stage == QUIETS)
+        scores[i] = scores[cursor];
+    cursor++;
+    return m;
+}
+
+bool MovePicker::next(CompactMove& m) {
+    for (;;) {
+        switch (stage) {
+        case TT_MOVE:
+            stage = GENERATE_PUSHES;
+            if (ttMove.size() > 0 && board.isLegal(ttMove)) {
+                m = ttMove;
+                return true;
+            }
+            ttMove = CompactMove();
+            break;
+
+        case GENERATE_PUSHES:
+            moves.clear();
+            board.generatePushes(side, moves);
+            cursor = 0;
+            stage = CAPTURES;
+            break;
+
+        case CAPTURES:
+            // In generation order; the list is short
+            for (int i = cursor; i < moves.size(); i++) {
+                if (Board::ejects(moves[i])) {
+                    m = take(i);
+                    if (m != ttMove)
+                        return true;
+                    i = cursor - 1;
+                }
+            }
+            stage = PUSHES;
+            break;
+
+        case PUSHES:
+            while (cursor < moves.size()) {
+                m = take(cursor);
+                if (m != ttMove)
+                    return true;
+            }
+            stage = GENERATE_QUIET;
+            break;
+
+        case GENERATE_QUIET:
+            moves.clear();
+            board.generateQuietMoves(side, moves);
+            cursor = 0;
+            for (int i = 0; i < moves.size(); i++)
+                scores[i] = ordering.history[side == Occupant::WHITE][Board::moveKey(moves[i])];
+            stage = KILLERS;
+            break;
+
+        case KILLERS:
+            while (killerIndex < 2) {
+                const CompactMove killer = ordering.killers[ply <= MoveOrdering::MAX_PLY ? ply : MoveOrdering::MAX_PLY][killerIndex++];
+                if (killer.size() == 0 || killer == ttMove)
+                    continue;
+                for (int i = cursor; i < moves.size(); i++) {
+                    if (moves[i] == killer) {
+                        m = take(i);
+                        return true;
+                    }
+                }
+            }
+            stage = QUIETS;
+            break;
+
+        case QUIETS:
+            // Selection of the best remaining history score: cut nodes rarely need a full sort
+            while (cursor < moves.size()) {
+                int best = cursor;
+                for (int i = cursor + 1; i < moves.size(); i++)
+                    if (scores[i] > scores[best])
+                        best = i;
+                m = take(best);
+                if (m != ttMove)
+                    return true;
+            }
+            stage = DONE;
+            break;
+
+        case DONE:
+            return false;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef ABALONE_MOVEPICKER_H
+#define ABALONE_MOVEPICKER_H
+
+#include "Board.h"
+
+// Quiet-move statistics the search keeps between nodes (one instance per Search)
+struct MoveOrdering
+{
+    static const int MAX_PLY = 64;
+
+    // Two quiet moves per ply that recently caused a beta cutoff there
+    CompactMove killers[MAX_PLY + 1][2];
+
+    // Cutoff credit per side and move key (Board::moveKey), depth * depth per cutoff
+    int history[2][MoveKeySet::NUM_KEYS];
+
+    void clear();
+
+    // A quiet move caused a cutoff at 'ply' with 'depth' plies left
+    void recordCutoff(const CompactMove& m, Occupant side, int ply, int depth);
+};
+
+// Hands out the moves of a position one at a time, best guesses first:
+//
+//   1. the transposition-table move (checked with Board::isLegal, nothing generated)
+//   2. captures: pushes that send a marble off the board
+//   3. the other sumito pushes
+//   4. the killer moves of this ply, if they are legal quiet moves here
+//   5. the remaining quiet moves, highest history score first
+//
+// Pushes are generated on their own (Board::generatePushes); the quiet moves are
+// only generated if the search gets past every push without a cutoff.
+class MovePicker
+{
+public:
+    MovePicker(const Board& board, const CompactMove& ttMove, const MoveOrdering& ordering, int ply);
+
+    // Next move in order; false when there are none left
+    bool next(CompactMove& m);
+
+private:
+    enum Stage
+    {
+        TT_MOVE,
+        GENERATE_PUSHES,
+        CAPTURES,
+        PUSHES,
+        GENERATE_QUIET,
+        KILLERS,
+        QUIETS,
+        DONE
+    };
+
+    const Board& board;
+    const MoveOrdering& ordering;
+    const int ply;
+    const Occupant side;
+    CompactMove ttMove;
+    Stage stage = TT_MOVE;
+
+    MoveList moves;     // pushes, then (once those are used up) the quiet moves
+    int cursor = 0;
+    int killerIndex = 0;
+    int scores[MoveList::CAPACITY];
+
+    // Remove moves[i] from the unused range [cursor, size) and return it
+    CompactMove take(int i);
+};
+
+#endif // ABALONE_MOVEPICKER_H
@@ -0,0 +1,243 @@
+#include "OpeningBook.h"
+#include "Search.h"
+#include "Symmetry.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+
+//========================== 0) Encoding ==========================//
+
+static void putU64(unsigned char* out, uint64_t v) {
+    for (int i = 0; i < 8; i++)
+        out[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint64_t getU64(const unsigned char* in) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v |= uint64_t(in[i]) << (8 * i);
+    return v;
+}
+
+static void encodeEntry(const OpeningBook::Entry& e, unsigned char* out) {
+    putU64(out, e.key);
+    out[8] = e.move.cells[0];
+    out[9] = e.move.cells[1];
+    out[10] = e.move.cells[2];
+    out[11] = e.move.info;
+    out[12] = (unsigned char)(uint16_t(int16_t(e.score)) & 0xFF);
+    out[13] = (unsigned char)(uint16_t(int16_t(e.score)) >> 8);
+    out[14] = (unsigned char)e.depth;
+    out[15] = 0;
+}
+
+OpeningBook::Entry OpeningBook::at(uint64_t i) const {
+    const unsigned char* in = entries + i * OpeningBookFile::ENTRY_SIZE;
+    Entry e;
+    e.key = getU64(in);
+    e.move.cells = { in[8], in[9], in[10] };
+    e.move.info = in[11];
+    e.score = int16_t(uint16_t(in[12] | (in[13] << 8)));
+    e.depth = in[14];
+    return e;
+}
+
+//========================== 1) Reading ==========================//
+
+bool OpeningBook::open(const std::string& path) {
+    valid = false;
+    entries = nullptr;
+    total = 0;
+    if (!file.open(path)) {
+        message = "could not open " + path;
+        return false;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(file.data());
+    if (file.size() < OpeningBookFile::HEADER_SIZE || std::memcmp(bytes, OpeningBookFile::MAGIC, 4) != 0) {
+        message = path + " is not an opening book";
+        return false;
+    }
+    const unsigned version = bytes[4] | (unsigned(bytes[5]) << 8);
+    if (version != OpeningBookFile::VERSION || bytes[6] != OpeningBookFile::ENTRY_SIZE) {
+        message = path + " has unsupported version " + std::to_string(version);
+        return false;
+    }
+    const uint64_t count = getU64(bytes + 8);
+    if ((file.size() - OpeningBookFile::HEADER_SIZE) / OpeningBookFile::ENTRY_SIZE < count) {
+        message = path + " is truncated";
+        return false;
+    }
+    total = count;
+    entries = bytes + OpeningBookFile::HEADER_SIZE;
+    valid = true;
+    message.clear();
+    return true;
+}
+
+bool OpeningBook::probe(const Board& board, Entry& out) const {
+    if (!valid || total == 0)
+        return false;
+    int symmetry;
+    const uint64_t key = Symmetry::canonicalHash(board.pack(), symmetry);
+
+    // Lower bound on the key, reading only the 8 key bytes of each probed entry
+    uint64_t lo = 0, hi = total;
+    while (lo < hi) {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        if (getU64(entries + mid * OpeningBookFile::ENTRY_SIZE) < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == total)
+        return false;
+    Entry e = at(lo);
+    if (e.key != key)
+        return false;
+    e.move = Symmetry::transformMove(e.move, Symmetry::inverse[symmetry]);
+    // A 64-bit key collision or a corrupt file must not produce an illegal move
+    if (!board.isLegal(e.move))
+        return false;
+    out = e;
+    return true;
+}
+
+//========================== 2) Writing ==========================//
+
+bool OpeningBook::write(const std::string& path, std::vector<Entry> list) {
+    std::stable_sort(list.begin(), list.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+    list.erase(std::unique(list.begin(), list.end(), [](const Entry& a, const Entry& b) { return a.key == b.key; }), list.end());
+
+    std::FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out)
+        return false;
+    unsigned char header[OpeningBookFile::HEADER_SIZE];
+    std::memcpy(header, OpeningBookFile::MAGIC, 4);
+    header[4] = (unsigned char)(OpeningBookFile::VERSION & 0xFF);
+    header[5] = (unsigned char)(OpeningBookFile::VERSION >> 8);
+    header[6] = (unsigned char)OpeningBookFile::ENTRY_SIZE;
+    header[7] = 0;
+    putU64(header + 8, list.size());
+    bool ok = std::fwrite(header, 1, sizeof(header), out) == sizeof(header);
+    unsigned char record[OpeningBookFile::ENTRY_SIZE];
+    for (size_t i = 0; ok && i < list.size(); i++) {
+        encodeEntry(list[i], record);
+        ok = std::fwrite(record, 1, sizeof(record), out) == sizeof(record);
+    }
+    return (std::fclose(out) == 0) && ok;
+}
+
+//========================== 3) Building ==========================//
+
+// Positions of one level, searched in parallel; each thread has its own table
+static std::vector<OpeningBook::Entry> searchLevel(const std::vector<PackedPosition>& level,
+    int depth, unsigned threads, size_t hashMb) {
+    std::vector<OpeningBook::Entry> found(level.size());
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        TranspositionTable tt(hashMb);
+        Search search(tt);
+        for (size_t i = next++; i < level.size(); i = next++) {
+            Board board;
+            board.unpack(level[i]);
+            const SearchResult result = search.run(board, depth);
+            int symmetry;
+            OpeningBook::Entry& e = found[i];
+            e.key = Symmetry::canonicalHash(level[i], symmetry);
+            e.move = Symmetry::transformMove(result.bestMove, symmetry);
+            e.score = result.score;
+            e.depth = result.depth;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < std::min<size_t>(threads, level.size()); t++)
+        pool.emplace_back(worker);
+    for (std::thread& t : pool)
+        t.join();
+    return found;
+}
+
+int runBook(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " book <out.book> [--depth N] [--plies N] [--threads N] [--hash MB]\n";
+        return 1;
+    }
+    const std::string outPath = argv[2];
+    int depth = 8;
+    int plies = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    size_t hashMb = TranspositionTable::DEFAULT_SIZE_MB;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--depth")
+            depth = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--plies")
+            plies = std::max(0, std::atoi(argv[i + 1]));
+        else if (arg == "--threads")
+            threads = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--hash")
+            hashMb = std::strtoul(argv[i + 1], nullptr, 10);
+        else {
+            std::cerr << "Error: unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // Level 0: the three starts; level k + 1: every position one move on from level k
+    std::vector<PackedPosition> level;
+    std::unordered_set<uint64_t> seen;
+    for (int layout = 0; layout < 3; layout++) {
+        Board board;
+        if (layout == 0)
+            board.initStandardLayout();
+        else if (layout == 1)
+            board.initBelgianDaisyLayout();
+        else
+            board.initGermanDaisyLayout();
+        if (seen.insert(Symmetry::canonicalHash(board.pack())).second)
+            level.push_back(board.pack());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<OpeningBook::Entry> book;
+    for (int ply = 0; ply <= plies && !level.empty(); ply++) {
+        for (const OpeningBook::Entry& e : searchLevel(level, depth, threads, hashMb))
+            if (e.move.size() > 0)
+                book.push_back(e);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "ply " << ply << " positions " << level.size() << " time " << seconds << "s" << std::endl;
+        if (ply == plies)
+            break;
+
+        std::vector<PackedPosition> nextLevel;
+        for (const PackedPosition& pos : level) {
+            Board board;
+            board.unpack(pos);
+            MoveList moves;
+            board.generateMoves(board.nextToMove, moves);
+            for (const CompactMove& m : moves) {
+                MoveUndo undo = board.applyMove(m);
+                const bool over = board.features.lost[0] >= Search::MARBLES_TO_LOSE
+                    || board.features.lost[1] >= Search::MARBLES_TO_LOSE;
+                if (!over && seen.insert(Symmetry::canonicalHash(board.pack())).second)
+                    nextLevel.push_back(board.pack());
+                board.undoMove(undo);
+            }
+        }
+        level.swap(nextLevel);
+    }
+
+    if (!OpeningBook::write(outPath, book)) {
+        std::cerr << "Error: could not write " << outPath << "\n";
+        return 1;
+    }
+    std::cout << "entries " << book.size() << " written to " << outPath << "\n";
+    return 0;
+}
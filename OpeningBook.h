@@ -0,0 +1,70 @@
+#ifndef ABALONE_OPENINGBOOK_H
+#define ABALONE_OPENINGBOOK_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Opening book file (".book"), all fields little-endian like PositionFile.h:
+//
+//   header, 16 bytes:  "ABOK" | uint16 version | uint8 entry size | uint8 reserved | uint64 count
+//   entry, 16 bytes:   uint64 key | 4 bytes move | int16 score | uint8 depth | uint8 reserved
+//
+// key is Symmetry::canonicalHash of the position, so one entry answers every
+// rotation, mirror image and colour swap of it; the move is stored in the
+// canonical frame (cells[0..2], then CompactMove::info). Entries are sorted by
+// key with no repeats, so a lookup is a binary search over the mapped file.
+namespace OpeningBookFile
+{
+    constexpr char MAGIC[4] = { 'A', 'B', 'O', 'K' };
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t HEADER_SIZE = 16;
+    constexpr size_t ENTRY_SIZE = 16;
+}
+
+// Read-only book: the file is memory-mapped by open() and searched in place.
+class OpeningBook
+{
+public:
+    struct Entry
+    {
+        uint64_t key = 0;
+        CompactMove move;   // canonical frame in the file, board frame from probe()
+        int score = 0;      // for the side to move
+        int depth = 0;      // search depth the entry came from
+    };
+
+    bool open(const std::string& path);
+    bool isOpen() const { return valid; }
+    const std::string& error() const { return message; }
+    uint64_t size() const { return total; }
+
+    // Book move for 'board', mapped back onto it and checked with Board::isLegal
+    bool probe(const Board& board, Entry& out) const;
+
+    // Sort 'entries' by key (the first of equal keys is kept) and write a book file
+    static bool write(const std::string& path, std::vector<Entry> entries);
+
+private:
+    Entry at(uint64_t i) const;
+
+    MappedFile file;
+    const unsigned char* entries = nullptr;
+    uint64_t total = 0;
+    bool valid = false;
+    std::string message;
+};
+
+// Book builder.
+//
+//   abalone book <out.book> [--depth N] [--plies N] [--threads N] [--hash MB]
+//
+// Searches the standard, Belgian Daisy and German Daisy starts and every position
+// reachable from them in up to --plies moves (default 1; positions equal under
+// Symmetry are searched once), each to --depth (default 8), on parallel threads
+// with one transposition table each, and writes the best moves to out.book.
+int runBook(int argc, char* argv[]);
+
+#endif // ABALONE_OPENINGBOOK_H
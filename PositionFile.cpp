@@ -0,0 +1,116 @@
+#include "PositionFile.h"
+#include <cstring>
+
+//========================== 0) Encoding ==========================//
+
+static void putU64(unsigned char* out, uint64_t v) {
+    for (int i = 0; i < 8; i++)
+        out[i] = (unsigned char)(v >> (8 * i));
+}
+
+static uint64_t getU64(const unsigned char* in) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+        v |= uint64_t(in[i]) << (8 * i);
+    return v;
+}
+
+void PositionFile::encode(const PackedPosition& pos, unsigned char* out) {
+    const uint64_t side = (pos.toMove == Occupant::WHITE) ? SIDE_BIT : 0;
+    putU64(out, pos.black | side);
+    putU64(out + 8, pos.white);
+}
+
+PackedPosition PositionFile::decode(const unsigned char* in) {
+    PackedPosition pos;
+    const uint64_t first = getU64(in);
+    pos.black = first & ~SIDE_BIT;
+    pos.white = getU64(in + 8);
+    pos.toMove = (first & SIDE_BIT) ? Occupant::WHITE : Occupant::BLACK;
+    return pos;
+}
+
+static void encodeHeader(unsigned char* out, int marblesPerSide, uint64_t count) {
+    std::memcpy(out, PositionFile::MAGIC, 4);
+    out[4] = (unsigned char)(PositionFile::VERSION & 0xFF);
+    out[5] = (unsigned char)(PositionFile::VERSION >> 8);
+    out[6] = (unsigned char)PositionFile::RECORD_SIZE;
+    out[7] = (unsigned char)marblesPerSide;
+    putU64(out + 8, count);
+}
+
+static_assert(Board::NUM_CELLS <= 63, "bit 63 of the black mask carries the side to move");
+
+//========================== 1) Writer ==========================//
+
+bool PositionFileWriter::open(const std::string& path, int marblesPerSide) {
+    close();
+    out = std::fopen(path.c_str(), "wb");
+    if (!out)
+        return false;
+    written = 0;
+    unsigned char header[PositionFile::HEADER_SIZE];
+    encodeHeader(header, marblesPerSide, 0);   // count is patched by close()
+    return std::fwrite(header, 1, sizeof(header), out) == sizeof(header);
+}
+
+bool PositionFileWriter::write(const PackedPosition& pos) {
+    unsigned char record[PositionFile::RECORD_SIZE];
+    PositionFile::encode(pos, record);
+    if (std::fwrite(record, 1, sizeof(record), out) != sizeof(record))
+        return false;
+    written++;
+    return true;
+}
+
+bool PositionFileWriter::close() {
+    if (!out)
+        return true;
+    unsigned char count[8];
+    putU64(count, written);
+    bool ok = std::fseek(out, 8, SEEK_SET) == 0
+        && std::fwrite(count, 1, sizeof(count), out) == sizeof(count);
+    ok = (std::fclose(out) == 0) && ok;
+    out = nullptr;
+    return ok;
+}
+
+//========================== 2) Reader ==========================//
+
+bool PositionFileReader::open(const std::string& path) {
+    valid = false;
+    records = nullptr;
+    total = 0;
+    if (!file.open(path)) {
+        message = "could not open " + path;
+        return false;
+    }
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(file.data());
+    if (file.size() < PositionFile::HEADER_SIZE || std::memcmp(bytes, PositionFile::MAGIC, 4) != 0) {
+        message = path + " is not a position file";
+        return false;
+    }
+    const unsigned version = bytes[4] | (unsigned(bytes[5]) << 8);
+    if (version != PositionFile::VERSION || bytes[6] != PositionFile::RECORD_SIZE) {
+        message = path + " has unsupported version " + std::to_string(version);
+        return false;
+    }
+    const uint64_t count = getU64(bytes + 8);
+    if ((file.size() - PositionFile::HEADER_SIZE) / PositionFile::RECORD_SIZE < count) {
+        message = path + " is truncated";
+        return false;
+    }
+    startMarbles = bytes[7];
+    total = count;
+    records = bytes + PositionFile::HEADER_SIZE;
+    valid = true;
+    message.clear();
+    return true;
+}
+
+int PositionFileReader::captured(uint64_t i, Occupant side) const {
+    const PackedPosition pos = at(i);
+    const uint64_t mask = (side == Occupant::BLACK) ? pos.black : pos.white;
+    const int onBoard = __builtin_popcountll(mask);
+    return onBoard < startMarbles ? startMarbles - onBoard : 0;
+}
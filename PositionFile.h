@@ -0,0 +1,80 @@
+#ifndef ABALONE_POSITIONFILE_H
+#define ABALONE_POSITIONFILE_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Fixed-width binary position corpus (".abp"), all fields little-endian:
+//
+//   header, 16 bytes:  "ABPF" | uint16 version | uint8 record size | uint8 marbles per side | uint64 count
+//   record, 16 bytes:  uint64 black mask, side to move in bit 63 (1 = white) | uint64 white mask
+//
+// Cells use bits 0-60 of each mask (bit i = cell index i). The masks leave only
+// 6 spare bits, too few for side + two 0..6 capture counts, so captures are not
+// stored: they are marbles-per-side (header) minus the marbles still on the board.
+namespace PositionFile
+{
+    constexpr char MAGIC[4] = { 'A', 'B', 'P', 'F' };
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t HEADER_SIZE = 16;
+    constexpr size_t RECORD_SIZE = 16;
+    constexpr int DEFAULT_MARBLES_PER_SIDE = 14;
+    constexpr uint64_t SIDE_BIT = uint64_t(1) << 63;
+
+    void encode(const PackedPosition& pos, unsigned char* out);
+    PackedPosition decode(const unsigned char* in);
+}
+
+// Streams records to disk; the count in the header is patched in by close().
+class PositionFileWriter
+{
+public:
+    PositionFileWriter() = default;
+    ~PositionFileWriter() { close(); }
+
+    PositionFileWriter(const PositionFileWriter&) = delete;
+    PositionFileWriter& operator=(const PositionFileWriter&) = delete;
+
+    bool open(const std::string& path, int marblesPerSide = PositionFile::DEFAULT_MARBLES_PER_SIDE);
+    bool write(const PackedPosition& pos);
+    bool close();
+
+    uint64_t count() const { return written; }
+
+private:
+    std::FILE* out = nullptr;
+    uint64_t written = 0;
+};
+
+// Random access over a memory-mapped position file: at(i) decodes record i in place.
+class PositionFileReader
+{
+public:
+    bool open(const std::string& path);
+    bool isOpen() const { return valid; }
+    const std::string& error() const { return message; }
+
+    uint64_t size() const { return total; }
+    int marblesPerSide() const { return startMarbles; }
+
+    PackedPosition at(uint64_t i) const {
+        return PositionFile::decode(records + i * PositionFile::RECORD_SIZE);
+    }
+    void load(uint64_t i, Board& board) const { board.unpack(at(i)); }
+
+    // Marbles the given side has lost in position i
+    int captured(uint64_t i, Occupant side) const;
+
+private:
+    MappedFile file;
+    const unsigned char* records = nullptr;
+    uint64_t total = 0;
+    int startMarbles = PositionFile::DEFAULT_MARBLES_PER_SIDE;
+    bool valid = false;
+    std::string message;
+};
+
+#endif // ABALONE_POSITIONFILE_H
@@ -0,0 +1,125 @@
+#include "PositionReader.h"
+
+//========================== 0) Setup ==========================//
+
+PositionReader::PositionReader(const std::string& path) {
+    if (file.open(path)) {
+        cursor = file.begin();
+        limit = file.end();
+    }
+}
+
+PositionReader::PositionReader(const char* begin, const char* end)
+    : cursor(begin), limit(end) {
+}
+
+//========================== 1) Scanning ==========================//
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool PositionReader::nextLine(const char*& begin, const char*& end) {
+    if (cursor == nullptr || cursor >= limit)
+        return false;
+    begin = cursor;
+    while (cursor < limit && *cursor != '\n')
+        cursor++;
+    end = cursor;
+    if (cursor < limit)
+        cursor++;   // past '\n'
+    line++;
+    return true;
+}
+
+// Like nextLine, but skips blank lines and leading whitespace
+bool PositionReader::nextNonBlankLine(const char*& begin, const char*& end) {
+    do {
+        if (!nextLine(begin, end))
+            return false;
+        while (begin < end && isSpace(*begin))
+            begin++;
+    } while (begin == end);
+    return true;
+}
+
+// Tokens look like "C5b": row letter A..I, column 1..9, colour b/w, separated by commas.
+void PositionReader::scanMarbles(const char* p, const char* end, PackedPosition& pos) {
+    while (p < end) {
+        while (p < end && (isSpace(*p) || *p == ','))
+            p++;
+        if (p >= end)
+            break;
+
+        const char* tokenEnd = p;
+        while (tokenEnd < end && *tokenEnd != ',')
+            tokenEnd++;
+        const char* last = tokenEnd;
+        while (last > p && isSpace(last[-1]))
+            last--;
+
+        // letter, one digit, colour: exactly three characters (columns never exceed 9)
+        int index = -1;
+        char colour = 0;
+        if (last - p == 3) {
+            int y = (p[0] | 0x20) - 'a' + 1;     // either case
+            int m = p[1] - '0';
+            colour = char(p[2] | 0x20);
+            if (y >= 1 && y <= 9 && m >= 1 && m <= 9)
+                index = Board::s_coordToIndex[y][m];
+        }
+        if (index >= 0 && colour == 'b')
+            pos.black |= uint64_t(1) << index;
+        else if (index >= 0 && colour == 'w')
+            pos.white |= uint64_t(1) << index;
+        else
+            skipped++;
+        p = tokenEnd;
+    }
+}
+
+// More marbles than any game has would overflow MoveList
+static bool tooManyMarbles(const PackedPosition& pos) {
+    return __builtin_popcountll(pos.black) > MoveList::MAX_MARBLES
+        || __builtin_popcountll(pos.white) > MoveList::MAX_MARBLES;
+}
+
+PositionReader::Status PositionReader::next(PackedPosition& pos) {
+    pos = PackedPosition();
+
+    // 1) Side to move: first non-blank line
+    const char* begin;
+    const char* end;
+    if (!nextNonBlankLine(begin, end))
+        return END;
+
+    const char side = char(*begin | 0x20);
+    if (side != 'b' && side != 'w')
+        return BAD_SIDE;
+    pos.toMove = (side == 'b') ? Occupant::BLACK : Occupant::WHITE;
+
+    // 2) Marbles: the very next line (may be empty)
+    if (!nextLine(begin, end))
+        return MISSING_MARBLES;
+    scanMarbles(begin, end, pos);
+    return tooManyMarbles(pos) ? TOO_MANY_MARBLES : OK;
+}
+
+PositionReader::Status PositionReader::nextMarbleLine(PackedPosition& pos, Occupant toMove) {
+    pos = PackedPosition();
+    pos.toMove = toMove;
+    const char* begin;
+    const char* end;
+    if (!nextNonBlankLine(begin, end))
+        return END;
+    scanMarbles(begin, end, pos);
+    return tooManyMarbles(pos) ? TOO_MANY_MARBLES : OK;
+}
+
+PositionReader::Status PositionReader::next(Board& board) {
+    PackedPosition pos;
+    Status status = next(pos);
+    if (status == OK)
+        board.unpack(pos);
+    return status;
+}
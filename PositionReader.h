@@ -0,0 +1,63 @@
+#ifndef ABALONE_POSITIONREADER_H
+#define ABALONE_POSITIONREADER_H
+
+#include "Board.h"
+#include "MappedFile.h"
+#include <string>
+
+// Scanner for the text position format used by the .input files:
+//
+//   b
+//   C5b,D5b,E4b,...
+//
+// A file may hold any number of these two-line records; blank lines between
+// records are ignored and '\r' is treated as whitespace. The file is memory
+// mapped and tokens are decoded in place, so reading a position allocates
+// nothing. Tokens that are not a valid cell followed by b/w are skipped and
+// counted. A side with more marbles than a game starts with is rejected, since
+// MoveList is sized for that many.
+class PositionReader
+{
+public:
+    enum Status
+    {
+        OK,
+        END,              // no positions left
+        BAD_SIDE,         // first line of a record does not start with b or w
+        MISSING_MARBLES,  // side line with no marble line after it
+        TOO_MANY_MARBLES  // more than MoveList::MAX_MARBLES of one colour
+    };
+
+    // Map and scan a file
+    explicit PositionReader(const std::string& path);
+    // Scan text that is already in memory (must outlive the reader)
+    PositionReader(const char* begin, const char* end);
+
+    bool isOpen() const { return cursor != nullptr || file.isOpen(); }
+
+    // Decode the next record. On an error the reader has moved past the bad line,
+    // so calling next() again continues with the following record.
+    Status next(PackedPosition& pos);
+    Status next(Board& board);
+
+    // Decode the next non-blank line as a bare marble list (the N-boards.txt format,
+    // which has no side line); toMove is taken from the caller.
+    Status nextMarbleLine(PackedPosition& pos, Occupant toMove);
+
+    int skippedTokens() const { return skipped; }
+    int lineNumber() const { return line; }   // lines consumed so far
+
+private:
+    MappedFile file;
+    const char* cursor = nullptr;
+    const char* limit = nullptr;
+    int skipped = 0;
+    int line = 0;
+
+    // [begin, end) of the next line without its '\n'; false at end of input
+    bool nextLine(const char*& begin, const char*& end);
+    bool nextNonBlankLine(const char*& begin, const char*& end);
+    void scanMarbles(const char* p, const char* end, PackedPosition& pos);
+};
+
+#endif // ABALONE_POSITIONREADER_H
@@ -0,0 +1,196 @@
+#include "Regress.h"
+#include "Board.h"
+#include "PositionReader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+//========================== 0) Cases ==========================//
+
+struct RegressCase
+{
+    int number = 0;
+    std::string input;
+    std::string expected;
+};
+
+// Result of one case; boards are (black mask, white mask) pairs
+struct RegressResult
+{
+    bool loaded = false;
+    std::string error;
+    int moves = 0;
+    size_t expectedCount = 0;
+    std::vector<std::pair<uint64_t, uint64_t>> missing;
+    std::vector<std::pair<uint64_t, uint64_t>> illegal;
+    std::vector<std::string> illegalMoves;   // move that produced each illegal board
+    double seconds = 0;
+
+    bool passed() const { return loaded && missing.empty() && illegal.empty(); }
+};
+
+// TestN.input with a matching TestN.board, ordered by N
+static std::vector<RegressCase> findCases(const std::string& dir) {
+    std::vector<RegressCase> cases;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        const fs::path& p = entry.path();
+        const std::string stem = p.stem().string();
+        if (p.extension() != ".input" || stem.size() <= 4 || stem.compare(0, 4, "Test") != 0
+            || !std::all_of(stem.begin() + 4, stem.end(), [](unsigned char c) { return c >= '0' && c <= '9'; }))
+            continue;
+        fs::path board = p;
+        board.replace_extension(".board");
+        if (!fs::is_regular_file(board, ec))
+            continue;
+        cases.push_back({ std::atoi(stem.c_str() + 4), p.string(), board.string() });
+    }
+    std::sort(cases.begin(), cases.end(), [](const RegressCase& a, const RegressCase& b) { return a.number < b.number; });
+    return cases;
+}
+
+//========================== 1) Running one case ==========================//
+
+static RegressResult runCase(const RegressCase& c) {
+    const auto start = std::chrono::steady_clock::now();
+    RegressResult result;
+
+    PositionReader input(c.input);
+    Board board;
+    if (!input.isOpen() || input.next(board) != PositionReader::OK) {
+        result.error = "could not load " + c.input;
+        return result;
+    }
+    if (input.skippedTokens() > 0)
+        result.error = std::to_string(input.skippedTokens()) + " invalid token(s) in " + c.input;
+
+    // Expected boards: one marble list per line (side to move does not matter here)
+    std::vector<std::pair<uint64_t, uint64_t>> expected;
+    PositionReader golden(c.expected);
+    PackedPosition pos;
+    while (golden.nextMarbleLine(pos, Occupant::BLACK) == PositionReader::OK)
+        expected.push_back({ pos.black, pos.white });
+    if (golden.skippedTokens() > 0)
+        result.error = std::to_string(golden.skippedTokens()) + " invalid token(s) in " + c.expected;
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    result.expectedCount = expected.size();
+
+    // Actual boards, generated in memory; remember the move behind each one
+    const Occupant side = board.nextToMove;
+    MoveList moves;
+    board.generateMoves(side, moves);
+    std::vector<std::pair<std::pair<uint64_t, uint64_t>, int>> actual;
+    actual.reserve(moves.size());
+    for (int i = 0; i < moves.size(); i++) {
+        MoveUndo undo = board.applyMove(moves[i]);
+        const PackedPosition after = board.pack();
+        board.undoMove(undo);
+        actual.push_back({ { after.black, after.white }, i });
+    }
+    result.moves = moves.size();
+
+    // Set differences both ways
+    std::sort(actual.begin(), actual.end());
+    std::vector<std::pair<uint64_t, uint64_t>> actualBoards;
+    for (size_t i = 0; i < actual.size(); i++) {
+        if (i > 0 && actual[i].first == actual[i - 1].first)
+            continue;
+        actualBoards.push_back(actual[i].first);
+        if (!std::binary_search(expected.begin(), expected.end(), actual[i].first)) {
+            result.illegal.push_back(actual[i].first);
+            result.illegalMoves.push_back(Board::moveToNotation(moves[actual[i].second], side));
+        }
+    }
+    std::set_difference(expected.begin(), expected.end(), actualBoards.begin(), actualBoards.end(),
+        std::back_inserter(result.missing));
+
+    result.loaded = true;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+//========================== 2) Runner ==========================//
+
+static std::string boardString(const std::pair<uint64_t, uint64_t>& masks) {
+    PackedPosition pos;
+    pos.black = masks.first;
+    pos.white = masks.second;
+    Board board;
+    board.unpack(pos);
+    return board.toBoardString();
+}
+
+int runRegress(int argc, char* argv[]) {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool verbose = false;
+    std::string dir = ".";
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc)
+            threads = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--verbose")
+            verbose = true;
+        else
+            dir = arg;
+    }
+
+    const std::vector<RegressCase> cases = findCases(dir);
+    if (cases.empty()) {
+        std::cerr << "Error: no TestN.input / TestN.board pairs in " << dir << "\n";
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<RegressResult> results(cases.size());
+    std::atomic<size_t> nextCase{ 0 };
+    auto worker = [&]() {
+        for (size_t i = nextCase++; i < cases.size(); i = nextCase++)
+            results[i] = runCase(cases[i]);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < std::min<size_t>(threads, cases.size()); t++)
+        pool.emplace_back(worker);
+    for (std::thread& t : pool)
+        t.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t SHOWN = 5;   // boards listed per failing case without --verbose
+    size_t failed = 0;
+    double caseSeconds = 0;
+    for (size_t i = 0; i < cases.size(); i++) {
+        const RegressResult& r = results[i];
+        caseSeconds += r.seconds;
+        std::cout << (r.passed() ? "PASS " : "FAIL ") << "Test" << cases[i].number;
+        if (!r.loaded) {
+            std::cout << "  " << r.error << "\n";
+            failed++;
+            continue;
+        }
+        std::cout << "  moves " << r.moves << ", expected " << r.expectedCount
+            << ", missing " << r.missing.size() << ", illegal " << r.illegal.size()
+            << ", " << r.seconds * 1000 << " ms\n";
+        if (!r.error.empty())
+            std::cout << "  warning: " << r.error << "\n";
+        if (r.passed())
+            continue;
+        failed++;
+        for (size_t k = 0; k < r.missing.size() && (verbose || k < SHOWN); k++)
+            std::cout << "  missing: " << boardString(r.missing[k]) << "\n";
+        for (size_t k = 0; k < r.illegal.size() && (verbose || k < SHOWN); k++)
+            std::cout << "  illegal: " << boardString(r.illegal[k]) << "  (move " << r.illegalMoves[k] << ")\n";
+    }
+
+    std::cout << "\ncases " << cases.size() << ", passed " << (cases.size() - failed) << ", failed " << failed
+        << ", threads " << pool.size() << ", time " << seconds << "s"
+        << " (" << caseSeconds << "s summed over cases)\n";
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#ifndef ABALONE_REGRESS_H
+#define ABALONE_REGRESS_H
+
+// Golden-file regression runner.
+//
+//   abalone regress [--threads N] [--verbose] [directory]
+//
+// Finds every TestN.input that has a TestN.board beside it (default: the current
+// directory), generates the one-ply boards in memory and compares them as a set
+// against the expected boards - the check compareBoards does by hand, without
+// writing N-boards.txt. Cases run in parallel; one line per case (with its time)
+// and a summary are printed in case order. Failing cases list the first few
+// missing and illegal boards (all of them with --verbose). Returns 1 if any case
+// fails.
+
+int runRegress(int argc, char* argv[]);
+
+#endif // ABALONE_REGRESS_H
@@ -0,0 +1,477 @@
+#include "Search.h"
+#include "ChildEval.h"
+#include "Evaluation.h"
+#include "OpeningBook.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+//========================== 0) Evaluation ==========================//
+
+int Search::evaluate(const Board& board) {
+    return Evaluation::evaluate(board);
+}
+
+//========================== 1) Tree search ==========================//
+
+int Search::scoreToTable(int score, int ply) {
+    if (score > WIN_BOUND) return score + ply;
+    if (score < -WIN_BOUND) return score - ply;
+    return score;
+}
+
+int Search::scoreFromTable(int score, int ply) {
+    if (score > WIN_BOUND) return score - ply;
+    if (score < -WIN_BOUND) return score + ply;
+    return score;
+}
+
+Search::TableKey Search::tableKey(const Board& board, int ply) {
+    TableKey key{ board.hash, Symmetry::IDENTITY };
+    if (ply < SYMMETRY_PLIES)
+        key.hash = Symmetry::canonicalHash(board.pack(), key.symmetry);
+    return key;
+}
+
+bool Search::probeTable(const TableKey& key, TranspositionTable::Entry& entry) const {
+    if (!tt.probe(key.hash, entry))
+        return false;
+    if (key.symmetry != Symmetry::IDENTITY)
+        entry.move = Symmetry::transformMove(entry.move, Symmetry::inverse[key.symmetry]);
+    return true;
+}
+
+void Search::storeTable(const TableKey& key, int depth, TranspositionTable::Bound bound, int score, const CompactMove& move) {
+    tt.store(key.hash, depth, bound, score, key.symmetry != Symmetry::IDENTITY ? Symmetry::transformMove(move, key.symmetry) : move);
+}
+
+// Move the transposition-table move (if it is in the list) to the front, or
+// failing that the first capture.
+static void orderFirstMove(MoveList& moves, const CompactMove& ttMove) {
+    int first = -1;
+    for (int i = 0; i < moves.size() && first < 0; i++)
+        if (ttMove.size() > 0 && moves[i] == ttMove)
+            first = i;
+    for (int i = 0; i < moves.size() && first < 0; i++)
+        if (Board::ejects(moves[i]))
+            first = i;
+    if (first > 0)
+        std::swap(moves[0], moves[first]);
+}
+
+void Search::recordCutoff(const Board& board, const CompactMove& m, int index, int depth, int ply) {
+    cutoffs++;
+    if (index == 0)
+        firstMoveCutoffs++;
+    if (m.pushCount() == 0)
+        ordering.recordCutoff(m, board.nextToMove, ply, depth);
+}
+
+// Upper bound (from the parent's side) on what searching batch child i would return,
+// given its static score: quiescence never returns less than stand-pat, so the
+// parent gets at most -static. Exact when the child has already lost.
+int Search::leafScore(const ChildBatch& children, int staticScore, int i, int ply) {
+    const uint64_t own = (children.toMove == Occupant::WHITE) ? children.white[i] : children.black[i];
+    if (__builtin_popcountll(own) <= Board::START_MARBLES - MARBLES_TO_LOSE)
+        return WIN_SCORE - ply;
+    return -staticScore;
+}
+
+// Search only pushes below the horizon until the position is quiet. Stand-pat: the
+// side to move may decline every push, so the static score is a lower bound.
+int Search::quiesce(Board& board, int alpha, int beta, int ply, int pushPlies) {
+    if (outOfTime())
+        return 0;
+    if (board.features.lost[board.nextToMove == Occupant::WHITE] >= MARBLES_TO_LOSE)
+        return -WIN_SCORE + ply;
+    const int standPat = evaluate(board);
+    if (standPat >= beta || ply >= MAX_PLY)
+        return standPat;
+    // Delta pruning: not even an ejection brings us back up to alpha
+    if (standPat + Evaluation::MARBLE_VALUE + DELTA_MARGIN <= alpha)
+        return standPat;
+    alpha = std::max(alpha, standPat);
+
+    MoveList moves;
+    if (pushPlies > 0)
+        board.generatePushes(board.nextToMove, moves);
+    else
+        board.generateCaptures(board.nextToMove, moves);
+
+    // Ejections first
+    int captures = 0;
+    for (int i = 0; i < moves.size(); i++)
+        if (Board::ejects(moves[i]))
+            std::swap(moves[captures++], moves[i]);
+
+    int bestScore = standPat;
+    for (int i = 0; i < moves.size(); i++) {
+        const int gain = (i < captures ? Evaluation::MARBLE_VALUE : 0) + DELTA_MARGIN;
+        if (standPat + gain <= alpha)
+            continue;
+
+        MoveUndo undo = board.applyMove(moves[i]);
+        nodes++;
+        quiescenceNodes++;
+        const int score = -quiesce(board, -beta, -alpha, ply + 1, pushPlies - 1);
+        board.undoMove(undo);
+        if (stopped)
+            return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta)
+                    break;
+            }
+        }
+    }
+    return bestScore;
+}
+
+int Search::negamax(Board& board, int depth, int alpha, int beta, int ply) {
+    if (outOfTime())
+        return 0;
+    // The previous move ejected our sixth marble.
+    if (board.features.lost[board.nextToMove == Occupant::WHITE] >= MARBLES_TO_LOSE)
+        return -WIN_SCORE + ply;
+    if (depth <= 0 || ply >= MAX_PLY)
+        return quiesce(board, alpha, beta, ply, QUIESCENCE_PUSH_PLIES);
+
+    const int alphaOrig = alpha;
+    CompactMove ttMove;
+    const TableKey key = tableKey(board, ply);
+    TranspositionTable::Entry entry;
+    if (probeTable(key, entry)) {
+        ttMove = entry.move;
+        if (entry.depth >= depth) {
+            int score = scoreFromTable(entry.score, ply);
+            if (entry.bound == TranspositionTable::BOUND_EXACT)
+                return score;
+            if (entry.bound == TranspositionTable::BOUND_LOWER)
+                alpha = std::max(alpha, score);
+            else if (entry.bound == TranspositionTable::BOUND_UPPER)
+                beta = std::min(beta, score);
+            if (alpha >= beta)
+                return score;
+        }
+    }
+
+    int bestScore = -INFINITE_SCORE;
+    CompactMove bestMove;
+
+    if (depth == 1) {
+        // Last ply: every child goes straight to quiescence. The first move is searched
+        // as usual, since it often cuts off on its own; the rest are scored in one batch
+        // from their masks first, and only children whose bound still beats alpha get
+        // the quiescence search - the others fail low on the batch score alone.
+        MoveList moves;
+        board.generateMoves(board.nextToMove, moves);
+        if (moves.empty())
+            return evaluate(board);
+        orderFirstMove(moves, ttMove);
+
+        ChildBatch children;
+        int childScores[ChildBatch::CAPACITY];
+        for (int i = 0; i < moves.size(); i++) {
+            int score = 0;
+            bool resolved = false;
+            if (i > 0) {
+                if (i == 1) {
+                    children.fromMoves(board, moves, 1);
+                    ChildEval::evaluate(children, childScores);
+                }
+                score = leafScore(children, childScores[i - 1], i - 1, ply + 1);
+                resolved = (score <= alpha || score > WIN_BOUND);
+                if (resolved)
+                    nodes++;
+            }
+            if (!resolved) {
+                MoveUndo undo = board.applyMove(moves[i]);
+                nodes++;
+                score = -negamax(board, 0, -beta, -alpha, ply + 1);
+                board.undoMove(undo);
+                if (stopped)
+                    return 0;
+            }
+
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = moves[i];
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= beta) {
+                        recordCutoff(board, moves[i], i, depth, ply);
+                        break;
+                    }
+                }
+            }
+        }
+    } else {
+        MovePicker picker(board, ttMove, ordering, ply);
+        CompactMove m;
+        int searched = 0;
+        while (picker.next(m)) {
+            MoveUndo undo = board.applyMove(m);
+            nodes++;
+
+            // PVS: full window for the first move, null window for the rest unless they beat alpha.
+            int score;
+            if (searched == 0) {
+                score = -negamax(board, depth - 1, -beta, -alpha, ply + 1);
+            } else {
+                score = -negamax(board, depth - 1, -alpha - 1, -alpha, ply + 1);
+                if (score > alpha && score < beta)
+                    score = -negamax(board, depth - 1, -beta, -alpha, ply + 1);
+            }
+            board.undoMove(undo);
+            if (stopped)
+                return 0;
+
+            if (score > bestScore) {
+                bestScore = score;
+                bestMove = m;
+                if (score > alpha) {
+                    alpha = score;
+                    if (alpha >= beta) {
+                        recordCutoff(board, m, searched, depth, ply);
+                        break;
+                    }
+                }
+            }
+            searched++;
+        }
+        if (bestMove.size() == 0)   // no legal moves
+            return evaluate(board);
+    }
+
+    TranspositionTable::Bound bound = bestScore <= alphaOrig ? TranspositionTable::BOUND_UPPER
+        : bestScore >= beta ? TranspositionTable::BOUND_LOWER
+        : TranspositionTable::BOUND_EXACT;
+    storeTable(key, depth, bound, scoreToTable(bestScore, ply), bestMove);
+    return bestScore;
+}
+
+int Search::searchRoot(Board& board, int depth, int alpha, int beta, CompactMove& best) {
+    const int alphaOrig = alpha;
+    CompactMove ttMove;
+    const TableKey key = tableKey(board, 0);
+    TranspositionTable::Entry entry;
+    if (probeTable(key, entry))
+        ttMove = entry.move;
+
+    MovePicker picker(board, ttMove, ordering, 0);
+    CompactMove m;
+    int searched = 0;
+    int bestScore = -INFINITE_SCORE;
+    while (picker.next(m)) {
+        MoveUndo undo = board.applyMove(m);
+        nodes++;
+
+        int score;
+        if (searched == 0) {
+            score = -negamax(board, depth - 1, -beta, -alpha, 1);
+        } else {
+            score = -negamax(board, depth - 1, -alpha - 1, -alpha, 1);
+            if (score > alpha && score < beta)
+                score = -negamax(board, depth - 1, -beta, -alpha, 1);
+        }
+        board.undoMove(undo);
+        if (stopped)
+            return 0;
+        searched++;
+
+        if (score > bestScore) {
+            bestScore = score;
+            best = m;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta)
+                    break;
+            }
+        }
+    }
+    if (searched == 0)
+        return evaluate(board);
+
+    TranspositionTable::Bound bound = bestScore <= alphaOrig ? TranspositionTable::BOUND_UPPER
+        : bestScore >= beta ? TranspositionTable::BOUND_LOWER
+        : TranspositionTable::BOUND_EXACT;
+    storeTable(key, depth, bound, bestScore, best);
+    return bestScore;
+}
+
+// Follow best moves through the table, checking each one is legal in its position.
+std::vector<CompactMove> Search::extractPv(Board& board, int maxLength) {
+    std::vector<CompactMove> pv;
+    std::vector<MoveUndo> undos;
+    TranspositionTable::Entry entry;
+    while ((int)pv.size() < maxLength && probeTable(tableKey(board, int(pv.size())), entry) && entry.move.size() > 0) {
+        MoveList moves;
+        board.generateMoves(board.nextToMove, moves);
+        if (std::find(moves.begin(), moves.end(), entry.move) == moves.end())
+            break;
+        pv.push_back(entry.move);
+        undos.push_back(board.applyMove(entry.move));
+    }
+    for (auto it = undos.rbegin(); it != undos.rend(); ++it)
+        board.undoMove(*it);
+    return pv;
+}
+
+//========================== 2) Time management ==========================//
+
+SearchLimits SearchLimits::moveTime(double ms) {
+    SearchLimits limits;
+    limits.hardMs = std::max(ms - Search::SAFETY_MS, ms / 2);
+    limits.softMs = ms * Search::MOVE_TIME_SOFT;
+    return limits;
+}
+
+SearchLimits SearchLimits::gameClock(double remainingMs, double incrementMs, int movesToGo) {
+    if (movesToGo <= 0)
+        movesToGo = Search::DEFAULT_MOVES_TO_GO;
+    const double share = remainingMs / movesToGo + 0.8 * incrementMs;
+    // An iteration may overrun its share, but never eat more than half the clock
+    SearchLimits limits;
+    limits.hardMs = std::max(1.0, std::min(4 * share, remainingMs / 2 + incrementMs) - Search::SAFETY_MS);
+    limits.softMs = std::min(share, limits.hardMs);
+    return limits;
+}
+
+bool Search::outOfTime() {
+    if (stopped)
+        return true;
+    if (!hasDeadline || --checkCountdown > 0)
+        return false;
+    checkCountdown = CHECK_INTERVAL;
+    stopped = std::chrono::steady_clock::now() >= hardDeadline;
+    return stopped;
+}
+
+//========================== 3) Iterative deepening ==========================//
+
+SearchResult Search::run(Board& board, int maxDepth, bool verbose) {
+    SearchLimits limits;
+    limits.maxDepth = maxDepth;
+    return run(board, limits, verbose);
+}
+
+SearchResult Search::run(Board& board, const SearchLimits& limits, bool verbose) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto msSince = [](Clock::time_point t) { return std::chrono::duration<double, std::milli>(Clock::now() - t).count(); };
+
+    SearchResult result;
+    result.budgetMs = limits.hardMs;
+    OpeningBook::Entry entry;
+    if (book && book->probe(board, entry)) {
+        result.bestMove = entry.move;
+        result.score = entry.score;
+        result.depth = entry.depth;
+        result.pv.push_back(entry.move);
+        result.fromBook = true;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (verbose)
+            std::cout << "book " << Board::moveToNotation(entry.move, board.nextToMove) << " score " << entry.score
+                << " depth " << entry.depth << " time " << result.seconds * 1e6 << "us" << std::endl;
+        return result;
+    }
+
+    nodes = quiescenceNodes = 0;
+    cutoffs = firstMoveCutoffs = 0;
+    ordering.clear();
+    tt.newSearch();
+    stopped = false;
+    checkCountdown = CHECK_INTERVAL;
+    hardDeadline = start + std::chrono::microseconds(int64_t(limits.hardMs * 1000));
+
+    int previous = 0;
+    std::vector<uint64_t> iterationNodes;   // nodes of each completed iteration
+    for (int depth = 1; depth <= limits.maxDepth; depth++) {
+        const auto iterationStart = Clock::now();
+        const uint64_t nodesBefore = nodes;
+        hasDeadline = (limits.hardMs > 0 && depth > 1);   // depth 1 always completes
+
+        // Aspiration window around the last score; widen whichever side fails.
+        int window = ASPIRATION_WINDOW;
+        int alpha = (depth > 1) ? std::max(previous - window, -INFINITE_SCORE) : -INFINITE_SCORE;
+        int beta = (depth > 1) ? std::min(previous + window, INFINITE_SCORE) : INFINITE_SCORE;
+
+        CompactMove best;
+        int score;
+        for (;;) {
+            score = searchRoot(board, depth, alpha, beta, best);
+            if (stopped)
+                break;
+            if (score <= alpha && alpha > -INFINITE_SCORE) {
+                window *= 2;
+                alpha = std::max(score - window, -INFINITE_SCORE);
+            } else if (score >= beta && beta < INFINITE_SCORE) {
+                window *= 2;
+                beta = std::min(score + window, INFINITE_SCORE);
+            } else {
+                break;
+            }
+        }
+        if (stopped) {
+            // Keep the last completed iteration; this one's partial result is not trusted
+            result.wastedMs = msSince(iterationStart);
+            if (verbose)
+                std::cout << "depth " << depth << " abandoned at the hard deadline after " << result.wastedMs << " ms" << std::endl;
+            break;
+        }
+
+        previous = score;
+        result.bestMove = best;
+        result.score = score;
+        result.depth = depth;
+        result.nodes = nodes;
+        result.quiescenceNodes = quiescenceNodes;
+        result.cutoffs = cutoffs;
+        result.firstMoveCutoffs = firstMoveCutoffs;
+        result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        result.pv = extractPv(board, depth);
+
+        if (verbose) {
+            std::cout << "depth " << depth << " score " << score << " nodes " << result.nodes
+                << " qnodes " << result.quiescenceNodes << " nps " << result.nodesPerSecond()
+                << " first-cut " << result.firstMoveCutoffRate() << "% time " << result.seconds << "s pv";
+            Occupant side = board.nextToMove;
+            for (const CompactMove& m : result.pv) {
+                std::cout << " " << Board::moveToNotation(m, side);
+                side = opponentOf(side);
+            }
+            std::cout << std::endl;
+        }
+
+        // Nothing to move, or a forced result: deeper iterations cannot change the answer.
+        if (best.size() == 0 || std::abs(score) > WIN_BOUND)
+            break;
+
+        // Next iteration: past the soft deadline, or expected to run into the hard one?
+        // Its cost is this one's times the growth in nodes. Odd and even depths grow very
+        // differently (an odd ply adds a full width of replies, an even one mostly
+        // cutoffs), so the growth is taken from the last step of the same parity.
+        iterationNodes.push_back(nodes - nodesBefore);
+        const size_t n = iterationNodes.size();
+        const double branching = n >= 3 ? std::max(1.0, double(iterationNodes[n - 2]) / double(std::max<uint64_t>(1, iterationNodes[n - 3])))
+            : n == 2 ? std::max(1.0, double(iterationNodes[1]) / double(std::max<uint64_t>(1, iterationNodes[0])))
+            : DEFAULT_BRANCHING;
+        const double elapsedMs = msSince(start);
+        if (limits.softMs > 0 && elapsedMs >= limits.softMs)
+            break;
+        if (limits.hardMs > 0 && elapsedMs + msSince(iterationStart) * branching > limits.hardMs)
+            break;
+    }
+
+    // Totals include an abandoned iteration
+    result.nodes = nodes;
+    result.quiescenceNodes = quiescenceNodes;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
@@ -0,0 +1,149 @@
+#ifndef ABALONE_SEARCH_H
+#define ABALONE_SEARCH_H
+
+#include "Board.h"
+#include "ChildEval.h"
+#include "MovePicker.h"
+#include "Symmetry.h"
+#include "TranspositionTable.h"
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class OpeningBook;
+
+// Result of one search call (the last completed iteration)
+struct SearchResult
+{
+    CompactMove bestMove;             // size() == 0 if the side to move has no moves
+    int score = 0;                    // from the side to move's point of view
+    int depth = 0;                    // deepest completed iteration
+    uint64_t nodes = 0;               // positions visited: each applyMove, and each leaf child settled by its batch score
+    uint64_t quiescenceNodes = 0;     // ... of which below the nominal depth (quiescence)
+    uint64_t cutoffs = 0;             // beta cutoffs inside the tree
+    uint64_t firstMoveCutoffs = 0;    // ... of which by the first move searched
+    double seconds = 0.0;
+    std::vector<CompactMove> pv;      // principal variation, starting with bestMove
+    bool fromBook = false;            // answered by the opening book, nothing searched
+    double budgetMs = 0.0;            // hard deadline of the search, 0 if it had none
+    double wastedMs = 0.0;            // spent on an iteration abandoned at the hard deadline
+
+    uint64_t nodesPerSecond() const { return seconds > 0 ? uint64_t(nodes / seconds) : nodes; }
+    // Share of cutoffs made by the first move, in percent: how good the move ordering is
+    double firstMoveCutoffRate() const { return cutoffs ? 100.0 * firstMoveCutoffs / cutoffs : 0.0; }
+};
+
+
+// How much run() may do. Deadlines are milliseconds from the start of run(), 0 = none.
+// No iteration is started after the soft deadline, nor one that is not expected to
+// finish before the hard deadline; an iteration still running at the hard deadline
+// is abandoned and the result of the last completed one is returned. Depth 1 always
+// completes, so there is always a move.
+struct SearchLimits
+{
+    int maxDepth = MoveOrdering::MAX_PLY;
+    double softMs = 0.0;
+    double hardMs = 0.0;
+
+    // Fixed time per move: unused time is lost, so plan to use most of it
+    static SearchLimits moveTime(double ms);
+    // Game clock: an equal share of what is left (plus most of the increment) per move
+    static SearchLimits gameClock(double remainingMs, double incrementMs, int movesToGo);
+};
+
+
+// Negamax alpha-beta search over Board::generateMoves / applyMove / undoMove.
+//
+// Iterative deepening from depth 1 up to maxDepth; each iteration after the first
+// starts with an aspiration window around the previous score and widens it on a
+// fail. Inside the tree it uses principal variation search (null-window probes
+// for every move after the first) and the shared transposition table for cutoffs.
+// Moves come from a MovePicker: table move, captures, pushes, killers, then the
+// quiet moves by history score (killers and history are reset by each run()).
+// Leaves are resolved by a quiescence search over pushes, so a pushing exchange
+// is played out instead of being scored halfway through.
+class Search
+{
+public:
+    static constexpr int WIN_SCORE = 30000;          // ejecting the sixth marble
+    static constexpr int WIN_BOUND = WIN_SCORE - 256; // scores beyond this are forced wins
+    static constexpr int INFINITE_SCORE = 32000;
+    static constexpr int ASPIRATION_WINDOW = 60;
+    static constexpr int MAX_PLY = MoveOrdering::MAX_PLY;
+    static constexpr int MARBLES_TO_LOSE = 6;        // ejected marbles that end the game
+
+    // Quiescence: every push for the first plies past the horizon, then only ejections
+    static constexpr int QUIESCENCE_PUSH_PLIES = 2;
+    // Most a push can change the static score besides the marble it may eject
+    // (delta pruning skips pushes that cannot lift stand-pat above alpha even so)
+    static constexpr int DELTA_MARGIN = 60;
+
+    // Plies from the root whose table entries are keyed by the canonical form, so that
+    // rotated, mirrored and colour-swapped transpositions share them. The key costs
+    // up to 12 mask permutations, paid only where subtrees are large.
+    static constexpr int SYMMETRY_PLIES = 4;
+
+    explicit Search(TranspositionTable& tt) : tt(tt) {}
+
+    // Answer positions found in 'book' from it instead of searching (nullptr: no book).
+    // The book must stay open while this Search uses it.
+    void setBook(const OpeningBook* openingBook) { book = openingBook; }
+
+    // Time management (see SearchLimits)
+    static constexpr int CHECK_INTERVAL = 4096;      // tree nodes between clock reads
+    static constexpr double MOVE_TIME_SOFT = 0.6;    // share of a fixed move time before no new iteration
+    static constexpr double SAFETY_MS = 5.0;         // kept back from every hard deadline
+    static constexpr int DEFAULT_MOVES_TO_GO = 30;
+    static constexpr double DEFAULT_BRANCHING = 6.0; // iteration time ratio before two are measured
+
+    // Search 'board' (position is restored on return). With 'verbose' set, prints one
+    // line per completed depth: score, nodes, nodes per second and the PV.
+    SearchResult run(Board& board, int maxDepth, bool verbose = false);
+    SearchResult run(Board& board, const SearchLimits& limits, bool verbose = false);
+
+    // Static score of 'board' for the side to move (Evaluation::evaluate)
+    static int evaluate(const Board& board);
+
+private:
+    int negamax(Board& board, int depth, int alpha, int beta, int ply);
+    int quiesce(Board& board, int alpha, int beta, int ply, int pushPlies);
+    static int leafScore(const ChildBatch& children, int staticScore, int i, int ply);
+    int searchRoot(Board& board, int depth, int alpha, int beta, CompactMove& best);
+    std::vector<CompactMove> extractPv(Board& board, int maxLength);
+
+    // Transposition-table key of a node: Board::hash, or within SYMMETRY_PLIES of the
+    // root the canonical hash plus the symmetry taking the board to its canonical form
+    // (the entry's move is stored in the canonical frame and mapped back on probe).
+    struct TableKey
+    {
+        uint64_t hash;
+        int symmetry;
+    };
+    static TableKey tableKey(const Board& board, int ply);
+    bool probeTable(const TableKey& key, TranspositionTable::Entry& entry) const;
+    void storeTable(const TableKey& key, int depth, TranspositionTable::Bound bound, int score, const CompactMove& move);
+
+    // Mate scores are stored relative to the node, not the root
+    static int scoreToTable(int score, int ply);
+    static int scoreFromTable(int score, int ply);
+
+    // A beta cutoff by m, the index-th move searched (0 = first): statistics, and killer / history credit if it is quiet
+    void recordCutoff(const Board& board, const CompactMove& m, int index, int depth, int ply);
+
+    TranspositionTable& tt;
+    const OpeningBook* book = nullptr;
+    MoveOrdering ordering;
+    uint64_t nodes = 0;
+    uint64_t quiescenceNodes = 0;
+    uint64_t cutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;
+
+    // Abandon the iteration once the hard deadline has passed (checked every CHECK_INTERVAL nodes)
+    bool outOfTime();
+    std::chrono::steady_clock::time_point hardDeadline;
+    bool hasDeadline = false;
+    bool stopped = false;
+    int checkCountdown = CHECK_INTERVAL;
+};
+
+#endif // ABALONE_SEARCH_H
@@ -0,0 +1,44 @@
+#ifndef ABALONE_SYMMETRY_H
+#define ABALONE_SYMMETRY_H
+
+#include "Board.h"
+#include <cstdint>
+
+// The 12 symmetries of the board (HexTopology::buildSymmetryCells) applied to packed
+// positions and moves, plus colour swap.
+//
+// Swapping the colours together with the side to move leaves every score the same
+// (the evaluation treats both colours alike), so a position has up to 24 variants
+// that all search the same. The canonical form picks one of them: colours are
+// swapped if white is to move, so black always moves, and of the 12 images the one
+// with the smallest (black, white) masks is kept. Variants of one position share
+// their canonical form and canonicalHash.
+struct Symmetry
+{
+    static constexpr int COUNT = HexTopology::NUM_SYMMETRIES;
+    static constexpr int IDENTITY = 0;
+
+    // cells[s][i] = image of cell i, directions[s][d] = image of direction d,
+    // inverse[s] = the symmetry that maps images back
+    static constexpr std::array<std::array<int8_t, Board::NUM_CELLS>, COUNT> cells = HexTopology::buildSymmetryCells();
+    static constexpr std::array<std::array<int8_t, Board::NUM_DIRECTIONS>, COUNT> directions = HexTopology::buildSymmetryDirections();
+    static constexpr std::array<int8_t, COUNT> inverse = HexTopology::buildInverseSymmetries();
+
+    // Image of a cell mask / position / move under symmetry s
+    static uint64_t transformMask(uint64_t mask, int s);
+    static PackedPosition transform(const PackedPosition& pos, int s);
+    static CompactMove transformMove(const CompactMove& m, int s);
+
+    // Canonical form of pos (toMove is always BLACK). 'symmetry' receives the s that
+    // takes pos onto it: a move m of pos is transformMove(m, symmetry) there, and a
+    // canonical move c is transformMove(c, inverse[symmetry]) back in pos.
+    static PackedPosition canonical(const PackedPosition& pos, int& symmetry);
+    static PackedPosition canonical(const PackedPosition& pos);
+
+    // 64-bit hash of the canonical form. Not Board::hash: it is computed from the
+    // masks on demand, not kept up to date by applyMove.
+    static uint64_t canonicalHash(const PackedPosition& pos, int& symmetry);
+    static uint64_t canonicalHash(const PackedPosition& pos);
+};
+
+#endif // ABALONE_SYMMETRY_H
@@ -0,0 +1,54 @@
+#include "Trace.h"
+#include <array>
+#include <memory>
+
+// One ring per thread, allocated on the first write so threads that never
+// trace (and every release build) pay nothing.
+struct TraceRing
+{
+    std::array<char, Trace::BUFFER_SIZE> data;
+    size_t head = 0;        // next byte to write
+    bool wrapped = false;   // data[head..] holds older text
+};
+
+static thread_local std::unique_ptr<TraceRing> t_ring;
+
+void Trace::write(const std::string& line) {
+    if (!t_ring)
+        t_ring.reset(new TraceRing());
+    TraceRing& ring = *t_ring;
+
+    auto put = [&](char c) {
+        ring.data[ring.head++] = c;
+        if (ring.head == BUFFER_SIZE) {
+            ring.head = 0;
+            ring.wrapped = true;
+        }
+    };
+    for (char c : line)
+        put(c);
+    put('\n');
+}
+
+void Trace::dump(std::ostream& out) {
+    if (!t_ring)
+        return;
+    const TraceRing& ring = *t_ring;
+
+    if (ring.wrapped) {
+        // The oldest line was partly overwritten; start after its end.
+        size_t start = ring.head;
+        while (start < BUFFER_SIZE && ring.data[start] != '\n')
+            start++;
+        if (start < BUFFER_SIZE)
+            out.write(ring.data.data() + start + 1, std::streamsize(BUFFER_SIZE - start - 1));
+    }
+    out.write(ring.data.data(), std::streamsize(ring.head));
+}
+
+void Trace::clear() {
+    if (t_ring) {
+        t_ring->head = 0;
+        t_ring->wrapped = false;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef ABALONE_TRACE_H
+#define ABALONE_TRACE_H
+
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+// Compile-time trace level for the move generator and applyMove.
+//
+//   0  off (default): every ABALONE_TRACE compiles to nothing and its
+//      arguments are never evaluated
+//   1  MOVE   moves being applied, pushes and ejections
+//   2  GROUP  groups considered and moves generated
+//   3  CELL   every cell, push chain and side-step checked
+//
+// Build with -DABALONE_TRACE_LEVEL=N to turn it on (make -f MakeFile trace).
+// Lines go to a per-thread ring buffer rather than std::cout; call
+// Trace::dump(std::cout) to print the most recent ones.
+#ifndef ABALONE_TRACE_LEVEL
+#define ABALONE_TRACE_LEVEL 0
+#endif
+
+struct Trace
+{
+    enum Level
+    {
+        MOVE = 1,
+        GROUP = 2,
+        CELL = 3
+    };
+
+    static constexpr int LEVEL = ABALONE_TRACE_LEVEL;
+    static constexpr size_t BUFFER_SIZE = size_t(1) << 16;   // bytes per thread; oldest lines are overwritten
+
+    static constexpr bool enabled(int level) { return level <= LEVEL; }
+
+    // Append one line to this thread's buffer
+    static void write(const std::string& line);
+
+    // Print this thread's buffered lines, oldest first
+    static void dump(std::ostream& out);
+    static void clear();
+};
+
+// ABALONE_TRACE(Trace::GROUP, "group " << a << " -> " << b);
+#define ABALONE_TRACE(level, expr)                  \
+    do {                                            \
+        if constexpr (Trace::enabled(level)) {      \
+            std::ostringstream traceLine_;          \
+            traceLine_ << expr;                     \
+            Trace::write(traceLine_.str());         \
+        }                                           \
+    } while (0)
+
+#endif // ABALONE_TRACE_H
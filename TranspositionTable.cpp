@@ -0,0 +1,122 @@
+#include "TranspositionTable.h"
+#include <climits>
+
+//========================== 0) Allocation ==========================//
+
+TranspositionTable::TranspositionTable(size_t megabytes) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes) {
+    // Largest power-of-two bucket count that fits in the requested size (at least one).
+    size_t wanted = (megabytes << 20) / sizeof(Bucket);
+    size_t count = 1;
+    while (count * 2 <= wanted)
+        count *= 2;
+
+    buckets.reset(new Bucket[count]);   // Slot's members start at zero
+    mask = count - 1;
+    age = 0;
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= mask; i++) {
+        for (Slot& slot : buckets[i].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    age = 0;
+}
+
+//========================== 1) Packing ==========================//
+
+uint64_t TranspositionTable::pack(const CompactMove& move, int score, int depth, Bound bound, int age) {
+    uint64_t m = uint64_t(move.cells[0])
+        | uint64_t(move.cells[1]) << 8
+        | uint64_t(move.cells[2]) << 16
+        | uint64_t(move.info) << 24;
+    return m
+        | uint64_t(uint16_t(int16_t(score))) << 32
+        | uint64_t(depth & 0xFF) << 48
+        | uint64_t(bound & 3) << 56
+        | uint64_t(age & AGE_MASK) << 58;
+}
+
+CompactMove TranspositionTable::unpackMove(uint64_t data) {
+    CompactMove m;
+    m.cells = { { uint8_t(data), uint8_t(data >> 8), uint8_t(data >> 16) } };
+    m.info = uint8_t(data >> 24);
+    return m;
+}
+
+//========================== 2) Probe / store ==========================//
+
+bool TranspositionTable::probe(uint64_t key, Entry& out) const {
+    const Bucket& bucket = buckets[key & mask];
+    for (const Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        // An empty slot or one half-written by another thread fails this test.
+        if (data == 0 || (check ^ data) != key)
+            continue;
+        out.move = unpackMove(data);
+        out.score = int16_t(uint16_t(data >> 32));
+        out.depth = unpackDepth(data);
+        out.bound = Bound((data >> 56) & 3);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, Bound bound, int score, const CompactMove& move) {
+    Bucket& bucket = buckets[key & mask];
+
+    // Pick the slot to overwrite: the same position if present, else an empty slot,
+    // else the shallowest entry, counting each search of age as 8 plies of depth.
+    Slot* victim = nullptr;
+    uint64_t victimData = 0;
+    int worst = INT_MAX;
+    for (Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if (data != 0 && (check ^ data) == key) {
+            victim = &slot;
+            victimData = data;
+            break;
+        }
+        int value = (data == 0) ? INT_MIN
+            : unpackDepth(data) - 8 * ((age - unpackAge(data)) & AGE_MASK);
+        if (value < worst) {
+            worst = value;
+            victim = &slot;
+            victimData = 0;
+        }
+    }
+
+    CompactMove best = move;
+    if (victimData != 0) {
+        // Same position: keep a deeper result from this search unless the new one is exact.
+        if (bound != BOUND_EXACT && unpackAge(victimData) == age && depth < unpackDepth(victimData) - 2)
+            return;
+        if (best.size() == 0)
+            best = unpackMove(victimData);
+    }
+
+    uint64_t data = pack(best, score, depth, bound, age);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    const size_t sample = (mask + 1 < 250) ? mask + 1 : 250;
+    int used = 0;
+    for (size_t i = 0; i < sample; i++) {
+        for (const Slot& slot : buckets[i].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data != 0 && unpackAge(data) == age)
+                used++;
+        }
+    }
+    return int(used * 1000 / (sample * ENTRIES_PER_BUCKET));
+}
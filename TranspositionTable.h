@@ -0,0 +1,90 @@
+#ifndef ABALONE_TRANSPOSITIONTABLE_H
+#define ABALONE_TRANSPOSITIONTABLE_H
+
+#include "Board.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+
+// Fixed-size hash table of search results, keyed by Board::hash.
+//
+// The table is a power-of-two array of 64-byte buckets, each holding four
+// 16-byte entries, so a probe touches exactly one cache line. Entries are two
+// 64-bit words: 'data' packs move/score/depth/bound/age, and 'check' stores
+// key ^ data. Threads read and write the words with relaxed atomics and no
+// locks; a torn entry (words from two different stores) fails the XOR check
+// on probe and is treated as a miss.
+class TranspositionTable
+{
+public:
+    static constexpr size_t DEFAULT_SIZE_MB = 16;
+    static constexpr int ENTRIES_PER_BUCKET = 4;
+
+    enum Bound : uint8_t
+    {
+        BOUND_NONE = 0,
+        BOUND_EXACT,    // score is the true value
+        BOUND_LOWER,    // failed high: true value >= score
+        BOUND_UPPER     // failed low:  true value <= score
+    };
+
+    // Unpacked view of a stored entry
+    struct Entry
+    {
+        CompactMove move;      // best / refutation move, size() == 0 if none
+        int score = 0;
+        int depth = 0;
+        Bound bound = BOUND_NONE;
+    };
+
+    // Size in megabytes, rounded down to a power-of-two number of buckets
+    explicit TranspositionTable(size_t megabytes = DEFAULT_SIZE_MB);
+
+    // Reallocate (and clear) the table. Not safe while other threads are probing.
+    void resize(size_t megabytes);
+    void clear();
+
+    // Start a new search: entries from earlier searches become preferred victims
+    void newSearch() { age = uint8_t((age + 1) & AGE_MASK); }
+
+    // Look up 'key'; fills 'out' and returns true on a hit
+    bool probe(uint64_t key, Entry& out) const;
+
+    // Store a result. Score must fit in 16 bits, depth in 0..255.
+    void store(uint64_t key, int depth, Bound bound, int score, const CompactMove& move);
+
+    size_t bucketCount() const { return mask + 1; }
+    size_t sizeInBytes() const { return bucketCount() * sizeof(Bucket); }
+
+    // Permille of sampled entries written during the current search
+    int hashfull() const;
+
+private:
+    static constexpr int AGE_MASK = 0x3F;   // 6 bits
+
+    struct Slot
+    {
+        std::atomic<uint64_t> check{ 0 };   // key ^ data
+        std::atomic<uint64_t> data{ 0 };
+    };
+
+    struct alignas(64) Bucket
+    {
+        Slot slots[ENTRIES_PER_BUCKET];
+    };
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+    // data layout: bits 0-31 move, 32-47 score, 48-55 depth, 56-57 bound, 58-63 age
+    static uint64_t pack(const CompactMove& move, int score, int depth, Bound bound, int age);
+    static CompactMove unpackMove(uint64_t data);
+    static int unpackDepth(uint64_t data) { return int((data >> 48) & 0xFF); }
+    static int unpackAge(uint64_t data) { return int(data >> 58); }
+
+    std::unique_ptr<Bucket[]> buckets;
+    size_t mask = 0;
+    uint8_t age = 0;
+};
+
+#endif // ABALONE_TRANSPOSITIONTABLE_H
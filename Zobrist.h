@@ -0,0 +1,44 @@
+#ifndef ABALONE_ZOBRIST_H
+#define ABALONE_ZOBRIST_H
+
+#include <array>
+#include <cstdint>
+
+// Zobrist keys for position hashing, generated at compile time.
+//
+// A position's key is the XOR of one random 64-bit value per (cell, colour)
+// that holds a marble, plus SIDE when white is to move. Moving a marble is
+// two XORs, so Board keeps its key up to date inside applyMove/undoMove.
+struct Zobrist
+{
+    static constexpr int NUM_CELLS = 61;
+
+    // splitmix64: small, well-mixed and usable in constant expressions
+    static constexpr uint64_t next(uint64_t& state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [cell][0] = black marble on cell, [cell][1] = white marble on cell
+    static constexpr std::array<std::array<uint64_t, 2>, NUM_CELLS> buildCellKeys()
+    {
+        std::array<std::array<uint64_t, 2>, NUM_CELLS> keys{};
+        uint64_t state = 0xAB41;
+        for (auto& cell : keys) {
+            cell[0] = next(state);
+            cell[1] = next(state);
+        }
+        return keys;
+    }
+
+    static constexpr uint64_t buildSideKey()
+    {
+        uint64_t state = 0x51DE;
+        return next(state);
+    }
+};
+
+#endif // ABALONE_ZOBRIST_H
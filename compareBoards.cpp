@@ -2,10 +2,16 @@
 #include <fstream>
 #include <sstream>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <algorithm>
 #include <cctype>
 #include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include "HexTopology.h"
+#include "MappedFile.h"
 
 // Helper: trim leading and trailing whitespace.
 std::string trim(const std::string& s) {
@@ -146,15 +152,385 @@ void compareBoardsAndMoves(const std::string& desiredFilename,
     }
 }
 
+// ---------------------------------------------------------------------------
+// Streaming mode (the default): every board line is parsed straight into a
+// packed key - one bit per (cell, colour) - and looked up in an open-addressing
+// hash table, so no per-line strings are built and only the unique boards are
+// kept in memory. Files are memory mapped and the actual/moves files are walked
+// once, in order. The report is byte-for-byte the same as the set-based version
+// above (still available with --legacy).
+// ---------------------------------------------------------------------------
+
+static constexpr auto CELL_INDEX = HexTopology::buildCoordToIndex();
+static constexpr auto CELL_NOTATION = HexTopology::buildNotation();
+static_assert(HexTopology::indexOrderIsLexicographic(), "packed keys rely on index order matching token order");
+
+// A normalized board. Token (cell, colour) sits at bit 2 * cell + (colour == 'w'),
+// so ascending bit order is exactly the sorted token order of normalizeBoardLine.
+// Lines with anything that is not a plain token ("C5b"), or with a token repeated,
+// cannot be represented that way; they keep their normalized string in a side
+// table and the key records its index there.
+struct BoardKey
+{
+    uint64_t lo = 0;    // bits for cells 0..31
+    uint64_t hi = 0;    // bits for cells 32..60; FALLBACK_BIT marks a string key
+
+    static constexpr uint64_t FALLBACK_BIT = uint64_t(1) << 63;
+
+    bool isFallback() const { return (hi & FALLBACK_BIT) != 0; }
+    bool operator==(const BoardKey& o) const { return lo == o.lo && hi == o.hi; }
+};
+
+static_assert(2 * HexTopology::NUM_CELLS <= 127, "packed key leaves the fallback bit free");
+
+static inline bool isSpaceChar(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Parse one line; returns the number of non-empty tokens. On success key holds the
+// packed board; a line that cannot be packed comes back with fallback = true.
+static int parseBoardLine(const char* p, const char* end, BoardKey& key, bool& fallback) {
+    key = BoardKey();
+    fallback = false;
+    int tokens = 0;
+    while (p < end) {
+        const char* tokenEnd = static_cast<const char*>(std::memchr(p, ',', size_t(end - p)));
+        if (!tokenEnd)
+            tokenEnd = end;
+        const char* first = p;
+        const char* last = tokenEnd;
+        while (first < last && isSpaceChar(*first))
+            first++;
+        while (last > first && isSpaceChar(last[-1]))
+            last--;
+        p = (tokenEnd < end) ? tokenEnd + 1 : end;
+        if (first == last)
+            continue;
+        tokens++;
+        if (fallback)
+            continue;
+
+        int bit = -1;
+        if (last - first == 3 && first[0] >= 'A' && first[0] <= 'I' && first[1] >= '1' && first[1] <= '9'
+            && (first[2] == 'b' || first[2] == 'w')) {
+            const int cell = CELL_INDEX[first[0] - 'A' + 1][first[1] - '0'];
+            if (cell >= 0)
+                bit = 2 * cell + (first[2] == 'w' ? 1 : 0);
+        }
+        uint64_t& word = (bit < 64) ? key.lo : key.hi;
+        const uint64_t mask = uint64_t(1) << (bit & 63);
+        if (bit < 0 || (word & mask))
+            fallback = true;   // not a plain token, or a repeat
+        else
+            word |= mask;
+    }
+    return tokens;
+}
+
+// Rebuild the normalized string of a packed key
+static void appendKeyString(std::string& out, const BoardKey& key) {
+    bool first = true;
+    for (int bit = 0; bit < 2 * HexTopology::NUM_CELLS; bit++) {
+        const uint64_t word = (bit < 64) ? key.lo : key.hi;
+        if (!((word >> (bit & 63)) & 1))
+            continue;
+        if (!first)
+            out += ',';
+        first = false;
+        const auto& cell = CELL_NOTATION[bit >> 1];
+        const char token[3] = { cell[0], cell[1], (bit & 1) ? 'w' : 'b' };
+        out.append(token, 3);
+    }
+}
+
+// Open-addressing (linear probing) set of keys, each with "seen in desired/actual" flags
+class BoardTable
+{
+public:
+    static const uint8_t IN_DESIRED = 1;
+    static const uint8_t IN_ACTUAL = 2;
+
+    struct Slot
+    {
+        BoardKey key;
+        uint8_t flags = 0;   // 0 = empty
+    };
+
+    BoardTable() : slots(1 << 16), used(0) {}
+
+    // Flags currently stored for key (0 if absent)
+    uint8_t find(const BoardKey& key) const {
+        for (size_t i = indexOf(key);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i].flags == 0)
+                return 0;
+            if (slots[i].key == key)
+                return slots[i].flags;
+        }
+    }
+
+    void mark(const BoardKey& key, uint8_t flag) {
+        if (2 * (used + 1) > slots.size())
+            grow();
+        for (size_t i = indexOf(key);; i = (i + 1) & (slots.size() - 1)) {
+            if (slots[i].flags == 0) {
+                slots[i].key = key;
+                slots[i].flags = flag;
+                used++;
+                return;
+            }
+            if (slots[i].key == key) {
+                slots[i].flags |= flag;
+                return;
+            }
+        }
+    }
+
+    const std::vector<Slot>& allSlots() const { return slots; }
+
+private:
+    std::vector<Slot> slots;
+    size_t used;
+
+    size_t indexOf(const BoardKey& key) const {
+        // splitmix64 finaliser over both words
+        uint64_t h = key.lo ^ (key.hi * 0x9E3779B97F4A7C15ull);
+        h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+        h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        return size_t(h) & (slots.size() - 1);
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        used = 0;
+        for (const Slot& s : old)
+            if (s.flags != 0)
+                mark(s.key, s.flags);
+    }
+};
+
+// Lines of a mapped file, split the way std::getline splits them
+class LineCursor
+{
+public:
+    explicit LineCursor(const MappedFile& file) : p(file.begin()), end(file.end()) {}
+
+    bool next(const char*& begin, const char*& stop) {
+        if (p == nullptr || p >= end)
+            return false;
+        begin = p;
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', size_t(end - p)));
+        stop = nl ? nl : end;
+        p = nl ? nl + 1 : end;
+        return true;
+    }
+
+private:
+    const char* p;
+    const char* end;
+};
+
+// Packs lines, interning the normalized string of lines that cannot be packed
+class BoardKeyer
+{
+public:
+    // Returns the number of tokens on the line
+    int key(const char* begin, const char* end, BoardKey& key) {
+        bool fallback;
+        const int tokens = parseBoardLine(begin, end, key, fallback);
+        if (fallback) {
+            std::string norm = normalizeBoardLine(std::string(begin, end));
+            auto it = fallbackIndex.find(norm);
+            uint64_t index;
+            if (it == fallbackIndex.end()) {
+                index = fallbackStrings.size();
+                fallbackIndex.emplace(norm, index);
+                fallbackStrings.push_back(norm);
+            }
+            else {
+                index = it->second;
+            }
+            key.lo = index;
+            key.hi = BoardKey::FALLBACK_BIT;
+        }
+        return tokens;
+    }
+
+    void appendString(std::string& out, const BoardKey& key) const {
+        if (key.isFallback())
+            out += fallbackStrings[key.lo];
+        else
+            appendKeyString(out, key);
+    }
+
+    // Orders keys as their normalized strings would sort. For packed keys: at the
+    // lowest token where the two differ, the board holding it sorts first unless the
+    // other board has no tokens past that point (then the other is a prefix of it).
+    bool less(const BoardKey& a, const BoardKey& b) const {
+        if (a.isFallback() || b.isFallback()) {
+            std::string sa, sb;
+            appendString(sa, a);
+            appendString(sb, b);
+            return sa < sb;
+        }
+        uint64_t diff = a.lo ^ b.lo;
+        int bit;
+        if (diff != 0) {
+            bit = __builtin_ctzll(diff);
+        }
+        else {
+            diff = a.hi ^ b.hi;
+            if (diff == 0)
+                return false;
+            bit = 64 + __builtin_ctzll(diff);
+        }
+        const BoardKey& holder = ((bit < 64 ? a.lo : a.hi) >> (bit & 63)) & 1 ? a : b;
+        const BoardKey& other = (&holder == &a) ? b : a;
+        bool otherHasMore;
+        if (bit < 63)
+            otherHasMore = (other.lo >> (bit + 1)) != 0 || other.hi != 0;
+        else if (bit == 63)
+            otherHasMore = other.hi != 0;
+        else
+            otherHasMore = (other.hi >> (bit - 63)) != 0;
+        const bool holderFirst = otherHasMore;
+        return (&holder == &a) ? holderFirst : !holderFirst;
+    }
+
+private:
+    std::vector<std::string> fallbackStrings;
+    std::unordered_map<std::string, uint64_t> fallbackIndex;
+};
+
+static std::string trimRange(const char* begin, const char* end) {
+    while (begin < end && isSpaceChar(*begin))
+        begin++;
+    while (end > begin && isSpaceChar(end[-1]))
+        end--;
+    return std::string(begin, end);
+}
+
+void compareBoardsStreaming(const std::string& desiredFilename,
+    const std::string& actualBoardFilename,
+    const std::string& movesFilename) {
+    BoardTable table;
+    BoardKeyer keyer;
+    BoardKey key;
+    const char* begin;
+    const char* end;
+
+    // Reference set
+    MappedFile desired(desiredFilename);
+    if (!desired.isOpen())
+        std::cerr << "Error: could not open file: " << desiredFilename << "\n";
+    for (LineCursor lines(desired); lines.next(begin, end);)
+        if (keyer.key(begin, end, key) > 0)
+            table.mark(key, BoardTable::IN_DESIRED);
+
+    // Stream the actual boards; remember which lines are illegal for the last section.
+    // Blank lines count too, just as the set version keeps them as "".
+    std::vector<std::pair<size_t, BoardKey>> illegalLines;
+    MappedFile actual(actualBoardFilename);
+    if (!actual.isOpen())
+        std::cerr << "Error: could not open file: " << actualBoardFilename << "\n";
+    size_t lineNumber = 0;
+    for (LineCursor lines(actual); lines.next(begin, end);) {
+        lineNumber++;
+        keyer.key(begin, end, key);
+        if ((table.find(key) & BoardTable::IN_DESIRED) == 0)
+            illegalLines.push_back({ lineNumber, key });
+        table.mark(key, BoardTable::IN_ACTUAL);
+    }
+
+    MappedFile moves(movesFilename);
+    if (!moves.isOpen())
+        std::cerr << "Error: could not open file: " << movesFilename << "\n";
+
+    std::vector<BoardKey> legal, missing;
+    for (const BoardTable::Slot& slot : table.allSlots()) {
+        if (slot.flags == (BoardTable::IN_DESIRED | BoardTable::IN_ACTUAL))
+            legal.push_back(slot.key);
+        else if (slot.flags == BoardTable::IN_DESIRED)
+            missing.push_back(slot.key);
+    }
+    auto byString = [&](const BoardKey& a, const BoardKey& b) { return keyer.less(a, b); };
+    std::sort(legal.begin(), legal.end(), byString);
+    std::sort(missing.begin(), missing.end(), byString);
+
+    std::string out;
+    auto flush = [&]() {
+        std::cout.write(out.data(), std::streamsize(out.size()));
+        out.clear();
+    };
+    auto writeKeys = [&](const std::vector<BoardKey>& keys) {
+        if (keys.empty())
+            out += "None\n";
+        for (const BoardKey& k : keys) {
+            keyer.appendString(out, k);
+            out += '\n';
+            if (out.size() > (1 << 20))
+                flush();
+        }
+    };
+
+    out += "=== Legal Board Configurations (present in both files) ===\n";
+    writeKeys(legal);
+    out += "\n=== Missing Board Configurations (in desired but not in actual) ===\n";
+    writeKeys(missing);
+    out += "\n=== Illegal Board Configurations (in actual but not in desired) ===\n";
+    if (illegalLines.empty())
+        out += "None\n";
+    LineCursor moveCursor(moves);
+    size_t moveLine = 0;
+    const char* moveBegin = nullptr;
+    const char* moveEnd = nullptr;
+    bool haveMove = false;
+    for (const auto& entry : illegalLines) {
+        // Advance through the moves file to the same line number
+        while (moveLine < entry.first && (haveMove = moveCursor.next(moveBegin, moveEnd)))
+            moveLine++;
+        out += "Line " + std::to_string(entry.first) + " illegal board: ";
+        keyer.appendString(out, entry.second);
+        out += '\n';
+        if (haveMove && moveLine == entry.first)
+            out += "  Corresponding move: " + trimRange(moveBegin, moveEnd) + "\n";
+        else
+            out += "  (No corresponding move found)\n";
+        if (out.size() > (1 << 20))
+            flush();
+    }
+    flush();
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <desired_board_file> <actual_board_file> <moves_file>\n";
+    bool legacy = false;
+    bool timing = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--legacy")
+            legacy = true;
+        else if (arg == "--time")
+            timing = true;
+        else
+            files.push_back(arg);
+    }
+    if (files.size() != 3) {
+        std::cerr << "Usage: " << argv[0] << " [--legacy] [--time] <desired_board_file> <actual_board_file> <moves_file>\n";
         return 1;
     }
-    std::string desiredFilename = argv[1];
-    std::string actualFilename = argv[2];
-    std::string movesFilename = argv[3];
+    std::string desiredFilename = files[0];
+    std::string actualFilename = files[1];
+    std::string movesFilename = files[2];
 
-    compareBoardsAndMoves(desiredFilename, actualFilename, movesFilename);
+    std::ios::sync_with_stdio(false);
+    const auto start = std::chrono::steady_clock::now();
+    if (legacy)
+        compareBoardsAndMoves(desiredFilename, actualFilename, movesFilename);
+    else
+        compareBoardsStreaming(desiredFilename, actualFilename, movesFilename);
+    if (timing)
+        std::cerr << "time " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s\n";
     return 0;
 }
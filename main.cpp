@@ -1,14 +1,105 @@
 #include "Board.h"
+#include "Batch.h"
+#include "OpeningBook.h"
+#include "Regress.h"
+#include "Search.h"
+#include "Trace.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
-#include <fstream> 
+#include <fstream>
+#include <string>
+#include <vector>
+
+// abalone search <file.input> [depth] [hashMB] [--book file.book]
+//                [--movetime ms | --clock ms [--inc ms] [--movestogo N]]
+// Runs the alpha-beta search on a position and prints one line per depth. With a
+// book, positions found in it are answered from the book without searching. With
+// a time control the search stops on its own (SearchLimits) and reports how much
+// of the budget it used; depth then defaults to no limit.
+static int runSearch(int argc, char* argv[]) {
+    std::string bookPath;
+    double moveTimeMs = 0, clockMs = 0, incrementMs = 0;
+    int movesToGo = 0;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = (i + 1 < argc);
+        if (arg == "--book" && hasValue)
+            bookPath = argv[++i];
+        else if (arg == "--movetime" && hasValue)
+            moveTimeMs = std::atof(argv[++i]);
+        else if (arg == "--clock" && hasValue)
+            clockMs = std::atof(argv[++i]);
+        else if (arg == "--inc" && hasValue)
+            incrementMs = std::atof(argv[++i]);
+        else if (arg == "--movestogo" && hasValue)
+            movesToGo = std::atoi(argv[++i]);
+        else
+            args.push_back(argv[i]);
+    }
+    if (args.size() < 3) {
+        std::cerr << "usage: " << argv[0] << " search <file.input> [depth] [hashMB] [--book file.book]\n"
+            << "       [--movetime ms | --clock ms [--inc ms] [--movestogo N]]\n";
+        return 1;
+    }
+
+    SearchLimits limits;
+    if (moveTimeMs > 0)
+        limits = SearchLimits::moveTime(moveTimeMs);
+    else if (clockMs > 0)
+        limits = SearchLimits::gameClock(clockMs, incrementMs, movesToGo);
+    const bool timed = (limits.hardMs > 0);
+    limits.maxDepth = (args.size() > 3) ? std::atoi(args[3]) : (timed ? Search::MAX_PLY : 4);
+    size_t hashMb = (args.size() > 4) ? std::strtoul(args[4], nullptr, 10) : TranspositionTable::DEFAULT_SIZE_MB;
+
+    Board board;
+    if (!board.loadFromInputFile(args[2])) {
+        std::cerr << "Could not load " << args[2] << "\n";
+        return 1;
+    }
+
+    OpeningBook book;
+    if (!bookPath.empty() && !book.open(bookPath)) {
+        std::cerr << "Error: " << book.error() << "\n";
+        return 1;
+    }
+
+    TranspositionTable tt(hashMb);
+    Search search(tt);
+    if (book.isOpen())
+        search.setBook(&book);
+    SearchResult result = search.run(board, limits, true);
+
+    std::cout << "bestmove " << (result.bestMove.size() ? Board::moveToNotation(result.bestMove, board.nextToMove) : "none")
+        << " score " << result.score << " nodes " << result.nodes
+        << " nps " << result.nodesPerSecond() << (result.fromBook ? " book" : "") << "\n";
+    if (timed) {
+        std::cout << "time used " << result.seconds * 1000 << " ms of " << result.budgetMs << " ms (soft "
+            << limits.softMs << " ms), unused " << std::max(0.0, result.budgetMs - result.seconds * 1000)
+            << " ms, wasted " << result.wastedMs << " ms\n";
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "search")
+        return runSearch(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "batch")
+        return runBatch(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "regress")
+        return runRegress(argc, argv);
+    if (argc > 1 && std::string(argv[1]) == "book")
+        return runBook(argc, argv);
 
-int main() {
     Board board;
     board.loadFromInputFile("Test1.input");
     // Suppose nextToMove is now Occupant::BLACK or Occupant::WHITE
 
     // Generate moves
-    auto moves = board.generateMoves(board.nextToMove);
+    const Occupant side = board.nextToMove;
+    auto moves = board.generateMoves(side);
 
     std::ofstream movesFile("1-moves.txt");
     std::ofstream boardsFile("1-boards.txt");
@@ -16,20 +107,22 @@ int main() {
     // For each move:
     for (auto& m : moves) {
         // Write the move in the doc notation
-        std::string moveNotation = Board::moveToNotation(m, board.nextToMove);
+        std::string moveNotation = Board::moveToNotation(m, side);
         movesFile << moveNotation << "\n";
 
-        // Create a copy to apply the move
-        Board copy = board;
-        copy.applyMove(m);
+        // Apply the move in place, record the result, then take it back
+        MoveUndo undo = board.applyMove(m);
 
         // Convert to occupant string
-        std::string occupantStr = copy.toBoardString();
+        std::string occupantStr = board.toBoardString();
         boardsFile << occupantStr << "\n";
+
+        board.undoMove(undo);
     }
 
+    // Trace builds: show what the generator and applyMove did (no-op otherwise)
+    if constexpr (Trace::LEVEL > 0)
+        Trace::dump(std::cout);
+
     return 0;
 }
-
-
-
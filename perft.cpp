@@ -0,0 +1,216 @@
+#include "BitBoard.h"
+#include "Board.h"
+#include "ChildEval.h"
+#include "Evaluation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Move-generator benchmark and regression check.
+//
+//   abaloneperft <file.input> <depth> [--bulk] [--check-eval] [--bitboard] [--check-bitboard]
+//
+// Counts the leaf positions of the full move tree below the position in
+// <file.input> (same two-line format as Test1.input), printing the count under
+// each root move ("divide") and the total with nodes per second. With --bulk the
+// last ply is counted straight from the move list instead of being applied.
+// --check-eval compares the incremental evaluation features with a full rescan
+// after every applyMove and undoMove, and the scores both ChildEval kernels give the
+// children of every node (one ChildBatch per node) with Evaluation::evaluateFromScratch;
+// it reports how many positions disagreed. --bitboard walks the tree with BitBoard
+// (copy-make) instead of Board, for comparing the two generators' speed.
+// --check-bitboard compares BitBoard's move set and the position after each of its
+// moves with Board's at every node.
+
+static bool s_checkEval = false;
+static uint64_t s_evalChecks = 0;
+static uint64_t s_evalMismatches = 0;
+static uint64_t s_batchChecks = 0;
+static uint64_t s_batchMismatches = 0;
+static bool s_checkBitBoard = false;
+static uint64_t s_bitBoardChecks = 0;
+static uint64_t s_bitBoardMismatches = 0;
+
+static void checkEval(const Board& board) {
+    s_evalChecks++;
+    if (!Evaluation::consistent(board))
+        s_evalMismatches++;
+}
+
+// The scalar kernel only runs on hosts without AVX2, so it is compared here directly
+static void checkChildEval(Board& board, const MoveList& moves) {
+    ChildBatch batch;
+    batch.fromMoves(board, moves);
+    int scalar[ChildBatch::CAPACITY];
+    int simd[ChildBatch::CAPACITY];
+    ChildEval::evaluateScalar(batch, scalar);
+    ChildEval::evaluateSimd(batch, simd);
+    for (int i = 0; i < moves.size(); i++) {
+        MoveUndo undo = board.applyMove(moves[i]);
+        const int reference = Evaluation::evaluateFromScratch(board);
+        board.undoMove(undo);
+        s_batchChecks++;
+        if (scalar[i] != reference || simd[i] != reference)
+            s_batchMismatches++;
+    }
+}
+
+// Same moves in the same encoding, in any order, and the same position after each
+static void checkBitBoard(Board& board, const MoveList& moves) {
+    const BitBoard bits = BitBoard::fromBoard(board);
+    MoveList bitMoves;
+    bits.generateMoves(board.nextToMove, bitMoves);
+    s_bitBoardChecks++;
+
+    auto key = [](const CompactMove& m) {
+        return uint32_t(m.cells[0]) | (uint32_t(m.cells[1]) << 8) | (uint32_t(m.cells[2]) << 16) | (uint32_t(m.info) << 24);
+    };
+    auto byKey = [&](const CompactMove& a, const CompactMove& b) { return key(a) < key(b); };
+    MoveList sorted = moves;
+    std::sort(sorted.begin(), sorted.end(), byKey);
+    std::sort(bitMoves.begin(), bitMoves.end(), byKey);
+    if (sorted.size() != bitMoves.size() || !std::equal(sorted.begin(), sorted.end(), bitMoves.begin())) {
+        s_bitBoardMismatches++;
+        return;
+    }
+    for (const CompactMove& m : bitMoves) {
+        BitBoard child = bits;
+        child.applyMove(m);
+        MoveUndo undo = board.applyMove(m);
+        const PackedPosition expected = board.pack();
+        board.undoMove(undo);
+        const PackedPosition actual = child.toBoard().pack();
+        if (actual.black != expected.black || actual.white != expected.white || actual.toMove != expected.toMove) {
+            s_bitBoardMismatches++;
+            return;
+        }
+    }
+}
+
+// Side is the colour to move; it alternates with each ply, so the generator and
+// applyMove run as their side-specialised instantiations all the way down.
+template <Occupant Side>
+static uint64_t perft(Board& board, int depth, bool bulk) {
+    MoveList moves;
+    board.generateMovesFor<Side>(moves);
+    if (s_checkEval)
+        checkChildEval(board, moves);
+    if (s_checkBitBoard)
+        checkBitBoard(board, moves);
+    if (bulk && depth == 1)
+        return uint64_t(moves.size());
+
+    uint64_t nodes = 0;
+    for (const CompactMove& m : moves) {
+        MoveUndo undo = board.applyMoveFor<Side>(m);
+        if (s_checkEval)
+            checkEval(board);
+        nodes += (depth <= 1) ? 1 : perft<opponentOf(Side)>(board, depth - 1, bulk);
+        board.undoMove(undo);
+        if (s_checkEval)
+            checkEval(board);
+    }
+    return nodes;
+}
+
+static uint64_t perft(Board& board, int depth, bool bulk) {
+    return board.nextToMove == Occupant::WHITE ? perft<Occupant::WHITE>(board, depth, bulk)
+        : perft<Occupant::BLACK>(board, depth, bulk);
+}
+
+// The BitBoard walk: each child is a modified copy, so there is nothing to undo
+static uint64_t perftBits(const BitBoard& bits, int depth, bool bulk) {
+    MoveList moves;
+    bits.generateMoves(bits.nextToMove, moves);
+    if (bulk && depth == 1)
+        return uint64_t(moves.size());
+
+    uint64_t nodes = 0;
+    for (const CompactMove& m : moves) {
+        BitBoard child = bits;
+        child.applyMove(m);
+        nodes += (depth <= 1) ? 1 : perftBits(child, depth - 1, bulk);
+    }
+    return nodes;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <file.input> <depth> [--bulk] [--check-eval] [--bitboard] [--check-bitboard]\n";
+        return 1;
+    }
+    const int depth = std::atoi(argv[2]);
+    bool bulk = false;
+    bool useBitBoard = false;
+    for (int i = 3; i < argc; i++) {
+        if (std::strcmp(argv[i], "--bulk") == 0)
+            bulk = true;
+        else if (std::strcmp(argv[i], "--check-eval") == 0)
+            s_checkEval = true;
+        else if (std::strcmp(argv[i], "--bitboard") == 0)
+            useBitBoard = true;
+        else if (std::strcmp(argv[i], "--check-bitboard") == 0)
+            s_checkBitBoard = true;
+    }
+    if (depth < 1) {
+        std::cerr << "depth must be at least 1\n";
+        return 1;
+    }
+
+    Board board;
+    if (!board.loadFromInputFile(argv[1])) {
+        std::cerr << "Could not load " << argv[1] << "\n";
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Divide: one line per root move
+    MoveList rootMoves;
+    const BitBoard rootBits = BitBoard::fromBoard(board);
+    if (useBitBoard)
+        rootBits.generateMoves(board.nextToMove, rootMoves);
+    else
+        board.generateMoves(board.nextToMove, rootMoves);
+    if (s_checkEval)
+        checkChildEval(board, rootMoves);
+    if (s_checkBitBoard)
+        checkBitBoard(board, rootMoves);
+    const Occupant side = board.nextToMove;
+    uint64_t total = 0;
+    for (const CompactMove& m : rootMoves) {
+        uint64_t count;
+        if (useBitBoard) {
+            BitBoard child = rootBits;
+            child.applyMove(m);
+            count = (depth == 1) ? 1 : perftBits(child, depth - 1, bulk);
+        } else {
+            MoveUndo undo = board.applyMove(m);
+            count = (depth == 1) ? 1 : perft(board, depth - 1, bulk);
+            board.undoMove(undo);
+        }
+        total += count;
+        std::cout << Board::moveToNotation(m, side) << ": " << count << "\n";
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "\nmoves " << rootMoves.size() << "\n"
+        << "nodes " << total << "\n"
+        << "time " << seconds << "s\n"
+        << "nps " << (seconds > 0 ? uint64_t(total / seconds) : total) << "\n"
+        << "duplicates suppressed " << Board::duplicateMovesSuppressed() << "\n";
+    if (s_checkBitBoard) {
+        std::cout << "bitboard checks " << s_bitBoardChecks << ", mismatches " << s_bitBoardMismatches << "\n";
+        if (s_bitBoardMismatches > 0)
+            return 1;
+    }
+    if (s_checkEval) {
+        std::cout << "evaluation checks " << s_evalChecks << ", mismatches " << s_evalMismatches << "\n"
+            << "batch checks " << s_batchChecks << ", mismatches " << s_batchMismatches
+            << (ChildEval::simdAvailable() ? " (scalar and AVX2)\n" : " (scalar only: no AVX2)\n");
+        return (s_evalMismatches == 0 && s_batchMismatches == 0) ? 0 : 1;
+    }
+    return 0;
+}
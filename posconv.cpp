@@ -0,0 +1,214 @@
+#include "PositionFile.h"
+#include "PositionReader.h"
+#include "Symmetry.h"
+#include "Zobrist.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+
+// Converter between the text position formats and the binary .abp format (PositionFile.h).
+//
+//   abaloneconv tobin <in.txt> <out.abp> [--side b|w]
+//   abaloneconv totext <in.abp> <out.txt> [--boards]
+//   abaloneconv dedup <in.abp> <out.abp> [--symmetric]
+//
+// tobin accepts either .input-style records (side line + marble line, any number of
+// them) or N-boards.txt-style marble lines; the latter carry no side to move, so
+// --side must say whose turn it is in every position (and is refused for records,
+// which name the side themselves). totext writes records, or
+// with --boards bare marble lines in the same format as N-boards.txt. dedup copies
+// the first occurrence of every position; with --symmetric, positions that are
+// rotations, mirror images or colour swaps of one another count as the same
+// (Symmetry.h) and only the first of them is kept.
+
+static int usage(const char* program) {
+    std::cerr << "usage: " << program << " tobin <in.txt> <out.abp> [--side b|w]\n"
+        << "       " << program << " totext <in.abp> <out.txt> [--boards]\n"
+        << "       " << program << " dedup <in.abp> <out.abp> [--symmetric]\n";
+    return 1;
+}
+
+static int toBinary(const std::string& inPath, const std::string& outPath, char sideOption) {
+    MappedFile text(inPath);
+    if (!text.isOpen()) {
+        std::cerr << "Error: could not open " << inPath << "\n";
+        return 1;
+    }
+
+    // Records start with a side line holding only b or w. A marble line starts with a
+    // row letter, and B is both, so a leading letter alone does not decide it.
+    const char* p = text.begin();
+    while (p < text.end() && std::isspace((unsigned char)*p))
+        p++;
+    bool records = (p < text.end() && (*p == 'b' || *p == 'B' || *p == 'w' || *p == 'W'));
+    if (records) {
+        const char* q = p + 1;
+        while (q < text.end() && (*q == ' ' || *q == '\t' || *q == '\r'))
+            q++;
+        records = (q == text.end() || *q == '\n');
+    }
+    if (!records && sideOption == 0) {
+        std::cerr << "Error: " << inPath << " has no side lines; pass --side b or --side w\n";
+        return 1;
+    }
+    if (records && sideOption != 0) {
+        std::cerr << "Error: " << inPath << " has side lines; --side only applies to bare marble lines\n";
+        return 1;
+    }
+    const Occupant side = (sideOption == 'w') ? Occupant::WHITE : Occupant::BLACK;
+
+    PositionFileWriter writer;
+    if (!writer.open(outPath)) {
+        std::cerr << "Error: could not create " << outPath << "\n";
+        return 1;
+    }
+    PositionReader reader(text.begin(), text.end());
+    PackedPosition pos;
+    for (;;) {
+        const PositionReader::Status status = records ? reader.next(pos) : reader.nextMarbleLine(pos, side);
+        if (status == PositionReader::END)
+            break;
+        if (status != PositionReader::OK) {
+            std::cerr << "Error: bad record ending at line " << reader.lineNumber() << " of " << inPath << "\n";
+            return 1;
+        }
+        if (!writer.write(pos)) {
+            std::cerr << "Error: write to " << outPath << " failed\n";
+            return 1;
+        }
+    }
+    const uint64_t count = writer.count();
+    if (!writer.close()) {
+        std::cerr << "Error: write to " << outPath << " failed\n";
+        return 1;
+    }
+    if (reader.skippedTokens() > 0)
+        std::cerr << "Warning: skipped " << reader.skippedTokens() << " invalid marble token(s)\n";
+    std::cout << "positions " << count << "\n";
+    return 0;
+}
+
+static int toText(const std::string& inPath, const std::string& outPath, bool boardsOnly) {
+    PositionFileReader reader;
+    if (!reader.open(inPath)) {
+        std::cerr << "Error: " << reader.error() << "\n";
+        return 1;
+    }
+    std::FILE* out = std::fopen(outPath.c_str(), "wb");
+    if (!out) {
+        std::cerr << "Error: could not create " << outPath << "\n";
+        return 1;
+    }
+
+    Board board;
+    std::string line;
+    for (uint64_t i = 0; i < reader.size(); i++) {
+        reader.load(i, board);
+        line.clear();
+        if (!boardsOnly) {
+            line += (board.nextToMove == Occupant::WHITE ? 'w' : 'b');
+            line += '\n';
+        }
+        board.appendBoardString(line);
+        line += '\n';
+        std::fwrite(line.data(), 1, line.size(), out);
+    }
+    if (std::fclose(out) != 0) {
+        std::cerr << "Error: write to " << outPath << " failed\n";
+        return 1;
+    }
+    std::cout << "positions " << reader.size() << "\n";
+    return 0;
+}
+
+// Both masks of a position; the side to move rides in bit 63 of the first, as in the file
+struct PositionKey
+{
+    uint64_t black;
+    uint64_t white;
+
+    bool operator==(const PositionKey& o) const { return black == o.black && white == o.white; }
+};
+
+struct PositionKeyHash
+{
+    size_t operator()(const PositionKey& k) const
+    {
+        uint64_t state = k.black ^ (k.white * 0x9E3779B97F4A7C15ull);
+        return size_t(Zobrist::next(state));
+    }
+};
+
+static int dedup(const std::string& inPath, const std::string& outPath, bool symmetric) {
+    PositionFileReader reader;
+    if (!reader.open(inPath)) {
+        std::cerr << "Error: " << reader.error() << "\n";
+        return 1;
+    }
+    PositionFileWriter writer;
+    if (!writer.open(outPath, reader.marblesPerSide())) {
+        std::cerr << "Error: could not create " << outPath << "\n";
+        return 1;
+    }
+
+    std::unordered_set<PositionKey, PositionKeyHash> seen;
+    seen.reserve(size_t(reader.size()));
+    for (uint64_t i = 0; i < reader.size(); i++) {
+        const PackedPosition pos = reader.at(i);
+        const PackedPosition key = symmetric ? Symmetry::canonical(pos) : pos;
+        const uint64_t side = (key.toMove == Occupant::WHITE) ? PositionFile::SIDE_BIT : 0;
+        if (!seen.insert(PositionKey{ key.black | side, key.white }).second)
+            continue;
+        if (!writer.write(pos)) {
+            std::cerr << "Error: write to " << outPath << " failed\n";
+            return 1;
+        }
+    }
+    const uint64_t count = writer.count();
+    if (!writer.close()) {
+        std::cerr << "Error: write to " << outPath << " failed\n";
+        return 1;
+    }
+    std::cout << "positions " << reader.size() << " kept " << count << " duplicates " << reader.size() - count << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4)
+        return usage(argv[0]);
+    const std::string mode = argv[1];
+    char side = 0;
+    bool boardsOnly = false;
+    bool symmetric = false;
+    for (int i = 4; i < argc; i++) {
+        if (std::strcmp(argv[i], "--side") == 0 && i + 1 < argc)
+            side = char(std::tolower((unsigned char)argv[++i][0]));
+        else if (std::strcmp(argv[i], "--boards") == 0)
+            boardsOnly = true;
+        else if (std::strcmp(argv[i], "--symmetric") == 0)
+            symmetric = true;
+        else
+            return usage(argv[0]);
+    }
+    if (side != 0 && side != 'b' && side != 'w')
+        return usage(argv[0]);
+
+    const auto start = std::chrono::steady_clock::now();
+    int result;
+    if (mode == "tobin")
+        result = toBinary(argv[2], argv[3], side);
+    else if (mode == "totext")
+        result = toText(argv[2], argv[3], boardsOnly);
+    else if (mode == "dedup")
+        result = dedup(argv[2], argv[3], symmetric);
+    else
+        return usage(argv[0]);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (result == 0)
+        std::cout << "time " << seconds << "s\n";
+    return result;
+}